@@ -0,0 +1,222 @@
+#ifndef __compiled_rulesetcpp__
+#define __compiled_rulesetcpp__
+
+#include "./compiled_ruleset.hpp"
+
+const std::size_t CCompiledRuleset::BlockRows = 2048;
+
+CCompiledRuleset::CCompiledRuleset( void ):
+    m_rule_begin( 1, 0 ), m_features( 0 ){
+}
+
+CCompiledRuleset::CCompiledRuleset( const CRuleset & ruleset ):
+    m_rule_begin( 1, 0 ), m_features( 0 ){
+
+  const double inf = std::numeric_limits<double>::infinity();
+
+  for( std::size_t r = 0; r < ruleset.size(); ++r ){
+    const CRule & rule = ruleset[r];
+
+    for( auto it = rule.o_cbegin(); it != rule.o_cend(); ++it ){
+      const CCondition & cond = rule[*it];
+      auto vals = cond.get_values();
+      CCheck check;
+
+      if( cond.get_index() > std::numeric_limits<std::uint32_t>::max() )
+        throw std::length_error( "Feature index out of range!" );
+
+      check.feature = cond.get_index();
+      m_features = std::max( m_features, cond.get_index() + 1 );
+      check.op = CCondition::EOperator::RANGE;
+      check.first = check.last = 0;
+      check.lower = -inf;
+      check.upper = inf;
+
+      switch( cond.get_operator_code() ){
+        case CCondition::EOperator::LE:
+          check.upper = vals.front();
+          break;
+        case CCondition::EOperator::GE:
+          check.lower = vals.front();
+          break;
+        case CCondition::EOperator::RANGE:
+          check.lower = vals[0];
+          check.upper = vals[1];
+          break;
+        case CCondition::EOperator::IN:
+          // get_values returns the set in ascending order
+          check.op = CCondition::EOperator::IN;
+          check.first = m_values.size();
+          m_values.insert( m_values.end(), vals.begin(), vals.end() );
+          check.last = m_values.size();
+          break;
+      }
+
+      m_checks.push_back( check );
+    }
+
+    m_rule_begin.push_back( m_checks.size() );
+    m_show_class.push_back( rule.shows_class() );
+    m_classes.push_back( rule.shows_class() ? rule.predicted_class() : 0 );
+  }
+}
+
+std::size_t CCompiledRuleset::size( void ) const{
+  return m_classes.size();
+}
+
+std::size_t CCompiledRuleset::checks( void ) const{
+  return m_checks.size();
+}
+
+std::size_t CCompiledRuleset::features( void ) const{
+  return m_features;
+}
+
+bool CCompiledRuleset::test( const CCheck & check, double x ) const{
+
+  if( check.op == CCondition::EOperator::RANGE )
+    return x >= check.lower && x <= check.upper;
+
+  // same search as the IN test of CCondition
+  auto first = m_values.begin() + check.first;
+  auto last = m_values.begin() + check.last;
+  if( check.last - check.first > 16 )
+    return x == x && std::binary_search( first, last, x );
+  for( ; first != last; ++first )
+    if( x == *first )
+      return true;
+  return false;
+}
+
+std::size_t CCompiledRuleset::covering_rule( const CDataset & data,
+                                             std::size_t row ) const{
+
+  std::size_t rules = size();
+
+  for( std::size_t r = 0; r < rules; ++r ){
+    std::size_t c = m_rule_begin[r];
+    std::size_t end = m_rule_begin[r + 1];
+    while( c < end && test( m_checks[c], data.column( m_checks[c].feature )[row] ) )
+      ++c;
+    if( c == end )
+      return r;
+  }
+
+  return rules;
+}
+
+std::size_t CCompiledRuleset::covering_rule( const double * row ) const{
+
+  std::size_t rules = size();
+
+  for( std::size_t r = 0; r < rules; ++r ){
+    std::size_t c = m_rule_begin[r];
+    std::size_t end = m_rule_begin[r + 1];
+    while( c < end && test( m_checks[c], row[ m_checks[c].feature ] ) )
+      ++c;
+    if( c == end )
+      return r;
+  }
+
+  return rules;
+}
+
+std::size_t CCompiledRuleset::predict_one( const double * row,
+                                           std::size_t positive_class,
+                                           std::size_t & rule ) const{
+  rule = covering_rule( row );
+
+  if( rule == size() )
+    return 0;
+
+  return m_show_class[rule] ? m_classes[rule] : positive_class;
+}
+
+std::uint64_t CCompiledRuleset::test_word( const CCheck & check, const double * x,
+                                           std::size_t n, std::uint64_t candidates ) const{
+  std::uint64_t passed = 0;
+
+  if( check.op == CCondition::EOperator::RANGE ){
+    // branchless, all rows of the word are tested
+    double lower = check.lower, upper = check.upper;
+    for( std::size_t b = 0; b < n; ++b )
+      passed |= std::uint64_t( x[b] >= lower && x[b] <= upper ) << b;
+  }
+  else{
+    for( std::uint64_t w = candidates; w; w &= w - 1 ){
+      std::size_t b = CCoverage::lowest_bit( w );
+      if( test( check, x[b] ) )
+        passed |= std::uint64_t( 1 ) << b;
+    }
+  }
+
+  return passed & candidates;
+}
+
+void CCompiledRuleset::covering_rules_tile( const CDataset & data,
+                                            std::size_t begin, std::size_t end,
+                                            std::uint32_t * out ) const{
+  const std::size_t bits = CCoverage::WordBits;
+  std::size_t rows = end - begin;
+  std::size_t words = ( rows + bits - 1 ) / bits;
+  std::uint32_t rules = size();
+
+  // rows no rule has fired for yet
+  std::uint64_t live[ BlockRows / 64 ];
+  std::uint64_t fired[ BlockRows / 64 ];
+  std::size_t n_live = rows;
+  for( std::size_t w = 0; w < words; ++w )
+    live[w] = rows - w * bits >= bits ? ~std::uint64_t( 0 ) :
+              ( std::uint64_t( 1 ) << ( rows - w * bits ) ) - 1;
+  std::fill( out, out + rows, rules );
+
+  for( std::uint32_t r = 0; r < rules && n_live; ++r ){
+    std::copy( live, live + words, fired );
+
+    for( std::size_t c = m_rule_begin[r]; c < m_rule_begin[r + 1]; ++c ){
+      const CCheck & check = m_checks[c];
+      const double * col = data.column( check.feature ) + begin;
+      bool any = false;
+      for( std::size_t w = 0; w < words; ++w ){
+        if( ! fired[w] )
+          continue;
+        fired[w] = test_word( check, col + w * bits,
+                              std::min( bits, rows - w * bits ), fired[w] );
+        any = any || fired[w];
+      }
+      if( ! any )
+        break;
+    }
+
+    for( std::size_t w = 0; w < words; ++w ){
+      if( ! fired[w] )
+        continue;
+      live[w] &= ~fired[w];
+      n_live -= CCoverage::popcount( fired[w] );
+      for( std::uint64_t x = fired[w]; x; x &= x - 1 )
+        out[ w * bits + CCoverage::lowest_bit( x ) ] = r;
+    }
+  }
+}
+
+void CCompiledRuleset::covering_rules( const CDataset & data,
+                                       std::size_t begin, std::size_t end,
+                                       std::uint32_t * out ) const{
+  for( std::size_t i = begin; i < end; i += BlockRows )
+    covering_rules_tile( data, i, std::min( end, i + BlockRows ), out + ( i - begin ) );
+}
+
+bool CCompiledRuleset::shows_class( std::size_t rule ) const{
+  return m_show_class.at( rule );
+}
+
+std::size_t CCompiledRuleset::predicted_class( std::size_t rule ) const{
+
+  if( ! m_show_class.at( rule ) )
+    throw std::runtime_error( "Prediction undefined!" );
+
+  return m_classes[rule];
+}
+
+#endif /*__compiled_rulesetcpp__*/
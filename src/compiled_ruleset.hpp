@@ -0,0 +1,120 @@
+#ifndef __compiled_rulesethpp__
+#define __compiled_rulesethpp__
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+#include "./dataset.hpp"
+#include "./coverage.hpp"
+#include "./ruleset.hpp"
+
+/**
+ * (C)CompiledRuleset is an immutable, flat form of a CRuleset
+ * used for prediction.
+ * - every condition becomes one fixed-size check, the checks of
+ *   all rules are stored back to back and m_rule_begin holds the
+ *   offset of the first check of every rule
+ * - { <=, >=, range } are all stored as a range, the missing bound
+ *   is infinite, so a NaN value fails them as before
+ * - the values of { in } conditions are kept sorted in one pool
+ * - all methods are const and the object holds no mutable state,
+ *   it can be read by any number of threads at once
+ */
+class CCompiledRuleset{
+
+  public:
+    /** empty ruleset */
+    CCompiledRuleset( void );
+    /**
+     * @in: ruleset
+     * - compile the rules in their order in the ruleset
+     */
+    explicit CCompiledRuleset( const CRuleset & ruleset );
+    /** return number of rules */
+    std::size_t size( void ) const;
+    /** return number of checks of all rules */
+    std::size_t checks( void ) const;
+    /** return number of features the rules read, highest index + 1 */
+    std::size_t features( void ) const;
+    /**
+     * @in: dataset, row
+     * @out: index of the first rule covering the row, size() if
+     *       no rule covers it
+     */
+    std::size_t covering_rule( const CDataset & data, std::size_t row ) const;
+    /**
+     * @in: row-major features of one sample
+     * @out: index of the first rule covering the sample, size() if
+     *       no rule covers it
+     * - the sample needs at least features() values
+     */
+    std::size_t covering_rule( const double * row ) const;
+    /**
+     * @in: row-major features of one sample, class predicted by
+     *      rules with no class set, index of the fired rule (out)
+     * @out: class of the first rule covering the sample, 0 if no
+     *       rule covers it (rule is then size())
+     * - nothing is allocated, for scoring one sample at a time
+     */
+    std::size_t predict_one( const double * row, std::size_t positive_class,
+                             std::size_t & rule ) const;
+    /**
+     * @in: dataset, first row, last row (exclusive), output
+     * - covering_rule for every row of [begin, end), out[i - begin]
+     *   receives the rule of the row i
+     * - rows are processed in tiles of BlockRows, a bitmask keeps
+     *   the rows of a tile no rule has fired for yet, every rule
+     *   reads only those rows and a tile is left as soon as all
+     *   its rows are retired
+     */
+    void covering_rules( const CDataset & data,
+                         std::size_t begin, std::size_t end,
+                         std::uint32_t * out ) const;
+    /** return true if a given rule has a predicted class set */
+    bool shows_class( std::size_t rule ) const;
+    /**
+     * @in: rule index
+     * @out: class predicted by the rule, see CRule::predicted_class
+     * - throws std::runtime_error if the rule has no class set
+     */
+    std::size_t predicted_class( std::size_t rule ) const;
+
+    /** number of rows in a tile of covering_rules */
+    const static std::size_t BlockRows;
+
+  private:
+    /** one condition: feature op value(s) */
+    struct CCheck{
+      std::uint32_t feature;
+      CCondition::EOperator op; // RANGE or IN
+      std::uint32_t first;      // [first, last) of m_values for IN
+      std::uint32_t last;
+      double lower;             // bounds for RANGE
+      double upper;
+    };
+
+    std::vector<CCheck> m_checks;
+    std::vector<std::uint32_t> m_rule_begin; // size() + 1 offsets into m_checks
+    std::vector<double> m_values;            // values of IN checks
+    std::vector<std::size_t> m_classes;      // predicted class of every rule
+    std::vector<bool> m_show_class;
+    std::size_t m_features;
+
+    /** test of a single value */
+    bool test( const CCheck & check, double x ) const;
+    /**
+     * @in: check, values of up to 64 consecutive rows, number of
+     *      rows, candidate rows
+     * @out: candidate rows passing the check
+     */
+    std::uint64_t test_word( const CCheck & check, const double * x,
+                             std::size_t n, std::uint64_t candidates ) const;
+    /** covering_rules of a single tile, at most BlockRows rows */
+    void covering_rules_tile( const CDataset & data,
+                              std::size_t begin, std::size_t end,
+                              std::uint32_t * out ) const;
+};
+
+#endif /*__compiled_rulesethpp__*/
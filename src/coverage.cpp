@@ -0,0 +1,149 @@
+#ifndef __coveragecpp__
+#define __coveragecpp__
+
+#include "./coverage.hpp"
+
+CCoverage::CCoverage( void ):
+    m_size( 0 ){
+}
+
+CCoverage::CCoverage( std::size_t size, bool value ):
+    m_words( ( size + WordBits - 1 ) / WordBits, value ? ~(std::uint64_t)0 : 0 ),
+    m_size( size ){
+
+  // clear the bits past size
+  if( value && size % WordBits )
+    m_words.back() = ( (std::uint64_t)1 << ( size % WordBits ) ) - 1;
+}
+
+CCoverage::CCoverage( std::size_t size, const std::vector<std::size_t> & indices ):
+    m_words( ( size + WordBits - 1 ) / WordBits, 0 ), m_size( size ){
+
+  for( const auto & i : indices ){
+    if( i >= m_size )
+      throw std::out_of_range( "Index out of range!" );
+    set( i );
+  }
+}
+
+std::size_t CCoverage::size( void ) const{
+  return m_size;
+}
+
+std::size_t CCoverage::count( void ) const{
+
+  std::size_t cnt = 0;
+
+  for( const auto & w : m_words )
+    cnt += popcount( w );
+
+  return cnt;
+}
+
+bool CCoverage::none( void ) const{
+
+  for( const auto & w : m_words )
+    if( w )
+      return false;
+
+  return true;
+}
+
+bool CCoverage::test( std::size_t idx ) const{
+  return ( m_words[ idx / WordBits ] >> ( idx % WordBits ) ) & 1;
+}
+
+void CCoverage::set( std::size_t idx ){
+  m_words[ idx / WordBits ] |= (std::uint64_t)1 << ( idx % WordBits );
+}
+
+void CCoverage::reset( std::size_t idx ){
+  m_words[ idx / WordBits ] &= ~( (std::uint64_t)1 << ( idx % WordBits ) );
+}
+
+CCoverage & CCoverage::operator&=( const CCoverage & x ){
+
+  check_size( x );
+
+  for( std::size_t i = 0; i < m_words.size(); ++i )
+    m_words[i] &= x.m_words[i];
+
+  return *this;
+}
+
+CCoverage & CCoverage::operator|=( const CCoverage & x ){
+
+  check_size( x );
+
+  for( std::size_t i = 0; i < m_words.size(); ++i )
+    m_words[i] |= x.m_words[i];
+
+  return *this;
+}
+
+CCoverage & CCoverage::and_not( const CCoverage & x ){
+
+  check_size( x );
+
+  for( std::size_t i = 0; i < m_words.size(); ++i )
+    m_words[i] &= ~x.m_words[i];
+
+  return *this;
+}
+
+bool CCoverage::operator==( const CCoverage & x ) const{
+  return m_size == x.m_size && m_words == x.m_words;
+}
+
+std::vector<std::size_t> CCoverage::to_indices( void ) const{
+
+  std::vector<std::size_t> indices;
+  indices.reserve( count() );
+
+  for( std::size_t i = 0; i < m_words.size(); ++i )
+    for( std::uint64_t w = m_words[i]; w; w &= w - 1 )
+      indices.push_back( i * WordBits + lowest_bit( w ) );
+
+  return indices;
+}
+
+std::size_t CCoverage::words( void ) const{
+  return m_words.size();
+}
+
+const std::uint64_t * CCoverage::data( void ) const{
+  return m_words.data();
+}
+
+std::uint64_t * CCoverage::data( void ){
+  return m_words.data();
+}
+
+std::size_t CCoverage::popcount( std::uint64_t word ){
+#if defined( __GNUC__ ) || defined( __clang__ )
+  return __builtin_popcountll( word );
+#else
+  std::size_t cnt = 0;
+  for( ; word; word &= word - 1 )
+    ++cnt;
+  return cnt;
+#endif
+}
+
+std::size_t CCoverage::lowest_bit( std::uint64_t word ){
+#if defined( __GNUC__ ) || defined( __clang__ )
+  return __builtin_ctzll( word );
+#else
+  std::size_t idx = 0;
+  for( ; ! ( word & 1 ); word >>= 1 )
+    ++idx;
+  return idx;
+#endif
+}
+
+void CCoverage::check_size( const CCoverage & x ) const{
+  if( m_size != x.m_size )
+    throw std::invalid_argument( "Coverage sizes differ!" );
+}
+
+#endif /*__coveragecpp__*/
@@ -0,0 +1,72 @@
+#ifndef __coveragehpp__
+#define __coveragehpp__
+
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+/**
+ * (C)Coverage is a bitmap over the rows of a dataset, the row i
+ * is set if it is covered (selected).
+ * - 64 rows are packed into one word, so that intersection and
+ *   difference of two coverages are word-wise operations and the
+ *   number of covered rows is a popcount
+ * - bits past size() are always zero
+ */
+class CCoverage{
+
+  public:
+    /** empty coverage */
+    CCoverage( void );
+    /**
+     * @in: number of rows, value
+     * - create a coverage with all rows set to value
+     */
+    explicit CCoverage( std::size_t size, bool value=false );
+    /**
+     * @in: number of rows, row indices
+     * - create a coverage with the given rows set
+     */
+    CCoverage( std::size_t size, const std::vector<std::size_t> & indices );
+    /** return number of rows */
+    std::size_t size( void ) const;
+    /** return number of covered rows */
+    std::size_t count( void ) const;
+    /** return true if no row is covered */
+    bool none( void ) const;
+    /** return true if a given row is covered */
+    bool test( std::size_t idx ) const;
+    void set( std::size_t idx );
+    void reset( std::size_t idx );
+    /** intersection */
+    CCoverage & operator&=( const CCoverage & x );
+    /** union */
+    CCoverage & operator|=( const CCoverage & x );
+    /** difference, i.e. this & ~x */
+    CCoverage & and_not( const CCoverage & x );
+    bool operator==( const CCoverage & x ) const;
+    /** return sorted indices of covered rows */
+    std::vector<std::size_t> to_indices( void ) const;
+    /** return number of words */
+    std::size_t words( void ) const;
+    /** return pointer to the words */
+    const std::uint64_t * data( void ) const;
+    std::uint64_t * data( void );
+
+    /** number of rows in one word */
+    const static std::size_t WordBits = 64;
+
+    /** return number of set bits in a word */
+    static std::size_t popcount( std::uint64_t word );
+    /** return index of the lowest set bit in a non-zero word */
+    static std::size_t lowest_bit( std::uint64_t word );
+
+  private:
+    std::vector<std::uint64_t> m_words;
+    std::size_t m_size;
+
+    /** throw if sizes of two coverages differ */
+    void check_size( const CCoverage & x ) const;
+};
+
+#endif /*__coveragehpp__*/
@@ -0,0 +1,559 @@
+#ifndef __datasetcpp__
+#define __datasetcpp__
+
+#include "./dataset.hpp"
+
+const std::size_t CDataset::Alignment = 64;
+
+CDataset::CDataset( void ):
+    m_buffer( nullptr ), m_data( nullptr ),
+    m_rows( 0 ), m_cols( 0 ), m_stride( 0 ), m_max_categories( 0 ){
+}
+
+CDataset::CDataset( const std::vector<std::vector<double>> & X ):
+    m_buffer( nullptr ), m_data( nullptr ),
+    m_rows( 0 ), m_cols( 0 ), m_stride( 0 ), m_max_categories( 0 ){
+
+  if( X.empty() )
+    return;
+
+  for( const auto & col : X )
+    if( col.size() != X.front().size() )
+      throw std::invalid_argument( "Feature sizes differ!" );
+
+  allocate( X.front().size(), X.size() );
+
+  for( std::size_t j = 0; j < m_cols; ++j )
+    std::copy( X[j].begin(), X[j].end(), column( j ) );
+}
+
+CDataset::CDataset( std::size_t rows, std::size_t cols ):
+    m_buffer( nullptr ), m_data( nullptr ),
+    m_rows( 0 ), m_cols( 0 ), m_stride( 0 ), m_max_categories( 0 ){
+
+  allocate( rows, cols );
+
+  for( std::size_t j = 0; j < m_cols; ++j )
+    std::fill( column( j ), column( j ) + m_rows, 0. );
+}
+
+CDataset::CDataset( const CDataset & src ):
+    m_buffer( nullptr ), m_data( nullptr ),
+    m_rows( 0 ), m_cols( 0 ), m_stride( 0 ), m_max_categories( 0 ){
+
+  allocate( src.m_rows, src.m_cols );
+  std::copy( src.m_data, src.m_data + m_cols * m_stride, m_data );
+  m_max_categories = src.m_max_categories;
+  m_categories = src.m_categories;
+  m_code_slot = src.m_code_slot;
+  m_codes = src.m_codes;
+}
+
+CDataset::CDataset( CDataset && src ) noexcept:
+    m_buffer( src.m_buffer ), m_data( src.m_data ),
+    m_rows( src.m_rows ), m_cols( src.m_cols ), m_stride( src.m_stride ),
+    m_max_categories( src.m_max_categories ),
+    m_categories( std::move( src.m_categories ) ),
+    m_code_slot( std::move( src.m_code_slot ) ),
+    m_codes( std::move( src.m_codes ) ){
+
+  // the buffer now belongs to this dataset
+  src.m_buffer = src.m_data = nullptr;
+  src.release();
+}
+
+CDataset::~CDataset( void ){
+  release();
+}
+
+CDataset & CDataset::operator=( const CDataset & src ){
+
+  if( &src == this )
+    return *this;
+
+  release();
+  allocate( src.m_rows, src.m_cols );
+  std::copy( src.m_data, src.m_data + m_cols * m_stride, m_data );
+  m_max_categories = src.m_max_categories;
+  m_categories = src.m_categories;
+  m_code_slot = src.m_code_slot;
+  m_codes = src.m_codes;
+
+  return *this;
+}
+
+CDataset & CDataset::operator=( CDataset && src ) noexcept{
+
+  if( &src == this )
+    return *this;
+
+  release();
+  m_buffer = src.m_buffer;
+  m_data = src.m_data;
+  m_rows = src.m_rows;
+  m_cols = src.m_cols;
+  m_stride = src.m_stride;
+  m_max_categories = src.m_max_categories;
+  m_categories = std::move( src.m_categories );
+  m_code_slot = std::move( src.m_code_slot );
+  m_codes = std::move( src.m_codes );
+
+  // the buffer now belongs to this dataset
+  src.m_buffer = src.m_data = nullptr;
+  src.release();
+
+  return *this;
+}
+
+std::size_t CDataset::rows( void ) const{
+  return m_rows;
+}
+
+std::size_t CDataset::cols( void ) const{
+  return m_cols;
+}
+
+std::size_t CDataset::stride( void ) const{
+  return m_stride;
+}
+
+bool CDataset::empty( void ) const{
+  return ! m_rows || ! m_cols;
+}
+
+const double * CDataset::column( std::size_t idx ) const{
+  return m_data + idx * m_stride;
+}
+
+double * CDataset::column( std::size_t idx ){
+  return m_data + idx * m_stride;
+}
+
+double CDataset::at( std::size_t row, std::size_t col ) const{
+  return m_data[ col * m_stride + row ];
+}
+
+std::vector<std::vector<double>> CDataset::to_vector( void ) const{
+
+  std::vector<std::vector<double>> X;
+
+  for( std::size_t j = 0; j < m_cols; ++j )
+    X.push_back( std::vector<double>( column( j ), column( j ) + m_rows ) );
+
+  return X;
+}
+
+void CDataset::encode_categories( std::size_t max_categories ){
+
+  m_max_categories = 0;
+  m_categories.clear();
+  m_code_slot.clear();
+  m_codes.clear();
+
+  if( ! max_categories || empty() )
+    return;
+
+  m_max_categories = max_categories;
+  m_categories.resize( m_cols );
+  m_code_slot.assign( m_cols, std::numeric_limits<std::size_t>::max() );
+
+  std::vector<double> sorted( m_rows );
+  std::size_t slots = 0;
+
+  for( std::size_t j = 0; j < m_cols; ++j ){
+    const double * col = column( j );
+
+    std::copy( col, col + m_rows, sorted.begin() );
+    if( std::any_of( sorted.begin(), sorted.end(),
+                     []( double x ){ return x != x; } ) )
+      continue;
+    std::sort( sorted.begin(), sorted.end() );
+    auto last = std::unique( sorted.begin(), sorted.end() );
+
+    if( (std::size_t)( last - sorted.begin() ) > max_categories )
+      continue;
+
+    m_categories[j].assign( sorted.begin(), last );
+    m_code_slot[j] = slots++;
+    m_codes.resize( slots * m_rows );
+
+    const auto & dict = m_categories[j];
+    std::uint32_t * codes = m_codes.data() + m_code_slot[j] * m_rows;
+    for( std::size_t i = 0; i < m_rows; ++i )
+      codes[i] = (std::uint32_t)( std::lower_bound( dict.begin(), dict.end(), col[i] ) -
+                                  dict.begin() );
+  }
+}
+
+std::size_t CDataset::max_categories( void ) const{
+  return m_max_categories;
+}
+
+bool CDataset::encoded( std::size_t idx ) const{
+  return idx < m_categories.size() && ! m_categories[idx].empty();
+}
+
+const std::vector<double> & CDataset::categories( std::size_t idx ) const{
+  return m_categories.at( idx );
+}
+
+const std::uint32_t * CDataset::codes( std::size_t idx ) const{
+  return m_codes.data() + m_code_slot.at( idx ) * m_rows;
+}
+
+void CDataset::allocate( std::size_t rows, std::size_t cols ){
+
+  m_rows = rows;
+  m_cols = cols;
+
+  if( ! m_rows || ! m_cols ){
+    m_stride = m_rows;
+    return;
+  }
+
+  // round the column length up, so that every column is aligned
+  const std::size_t lane = Alignment / sizeof( double );
+  m_stride = ( m_rows + lane - 1 ) / lane * lane;
+
+  // over-allocate by one lane to be able to align the begin
+  std::size_t size = m_cols * m_stride;
+  std::size_t space = ( size + lane ) * sizeof( double );
+  m_buffer = new double[ size + lane ];
+  void * ptr = m_buffer;
+  m_data = static_cast<double*>( std::align( Alignment, size * sizeof( double ),
+                                             ptr, space ) );
+
+  for( std::size_t j = 0; j < m_cols; ++j )
+    std::fill( column( j ) + m_rows, column( j ) + m_stride,
+               std::numeric_limits<double>::quiet_NaN() );
+}
+
+void CDataset::release( void ){
+  delete [] m_buffer;
+  m_buffer = m_data = nullptr;
+  m_rows = m_cols = m_stride = 0;
+  m_max_categories = 0;
+  m_categories.clear();
+  m_code_slot.clear();
+  m_codes.clear();
+}
+
+const std::size_t CSortedIndex::MaxRows =
+  std::numeric_limits<std::uint32_t>::max();
+const std::size_t CSortedIndex::RankedRatio = 8;
+// ranks fit 16 bits, class counts of all ranked columns stay small
+const std::size_t CSortedIndex::MaxRankedValues = 1 << 16;
+const std::size_t CSortedIndex::MaxRankedTotal = 1 << 18;
+
+CSortedIndex::CSortedIndex( void ):
+    m_rows( 0 ), m_cols( 0 ), m_source( nullptr ){
+}
+
+CSortedIndex::CSortedIndex( const CDataset & data ):
+    m_rows( data.rows() ), m_cols( data.cols() ), m_source( nullptr ){
+
+  if( m_rows > MaxRows )
+    throw std::length_error( "Too many rows to index!" );
+
+  if( data.empty() )
+    return;
+
+  m_source = data.column( 0 );
+  m_order.resize( m_rows * m_cols );
+
+  for( std::size_t j = 0; j < m_cols; ++j ){
+    const double * col = data.column( j );
+    auto begin = m_order.begin() + j * m_rows;
+    auto end = begin + m_rows;
+
+    std::iota( begin, end, 0 );
+    // NaN breaks the ordering, NaN rows are moved behind the others
+    auto nan = std::stable_partition( begin, end,
+      [&]( std::uint32_t a ){ return ! std::isnan( col[a] ); }
+    );
+    std::stable_sort( begin, nan,
+      [&]( std::uint32_t a, std::uint32_t b ){ return col[a] < col[b]; }
+    );
+  }
+
+  m_values.resize( m_cols );
+  m_rank_slot.assign( m_cols, std::numeric_limits<std::size_t>::max() );
+
+  std::size_t slots = 0, total = 0;
+  std::size_t max_values = std::min( m_rows / RankedRatio, MaxRankedValues );
+  std::vector<double> values;
+
+  for( std::size_t j = 0; j < m_cols && total < MaxRankedTotal; ++j ){
+    const double * col = data.column( j );
+    const std::uint32_t * order = column( j );
+
+    // NaN has no place in the order, such a column is not ranked
+    values.clear();
+    bool nan = false;
+    for( std::size_t i = 0; i < m_rows && ! nan &&
+                            values.size() <= max_values; ++i ){
+      double val = col[ order[i] ];
+      nan = val != val;
+      if( values.empty() || values.back() != val )
+        values.push_back( val );
+    }
+    if( nan || values.size() > max_values ||
+        total + values.size() > MaxRankedTotal )
+      continue;
+
+    total += values.size();
+    m_values[j] = values;
+    m_rank_slot[j] = slots++;
+    m_ranks.resize( slots * m_rows );
+
+    std::uint16_t * ranks = m_ranks.data() + m_rank_slot[j] * m_rows;
+    std::uint16_t rank = 0;
+    for( std::size_t i = 0; i < m_rows; ++i ){
+      if( i && col[ order[i] ] != col[ order[i - 1] ] )
+        ++rank;
+      ranks[ order[i] ] = rank;
+    }
+  }
+}
+
+std::size_t CSortedIndex::rows( void ) const{
+  return m_rows;
+}
+
+std::size_t CSortedIndex::cols( void ) const{
+  return m_cols;
+}
+
+bool CSortedIndex::empty( void ) const{
+  return m_order.empty();
+}
+
+bool CSortedIndex::built_for( const CDataset & data ) const{
+  return ! empty() && data.rows() == m_rows && data.cols() == m_cols &&
+         data.column( 0 ) == m_source;
+}
+
+const std::uint32_t * CSortedIndex::column( std::size_t idx ) const{
+  return m_order.data() + idx * m_rows;
+}
+
+bool CSortedIndex::ranked( std::size_t idx ) const{
+  return idx < m_values.size() && ! m_values[idx].empty();
+}
+
+const std::uint16_t * CSortedIndex::ranks( std::size_t idx ) const{
+  return m_ranks.data() + m_rank_slot.at( idx ) * m_rows;
+}
+
+const std::vector<double> & CSortedIndex::values( std::size_t idx ) const{
+  return m_values.at( idx );
+}
+
+const std::size_t CBinnedDataset::MaxBins = 256;
+
+CBinnedDataset::CBinnedDataset( void ):
+    m_rows( 0 ), m_cols( 0 ), m_source( nullptr ){
+}
+
+CBinnedDataset::CBinnedDataset( const CDataset & data, std::size_t max_bins ):
+    m_rows( data.rows() ), m_cols( data.cols() ), m_source( nullptr ){
+
+  if( max_bins < 2 || max_bins > MaxBins )
+    throw std::invalid_argument( "Invalid number of bins!" );
+
+  if( data.empty() )
+    return;
+
+  m_source = data.column( 0 );
+  m_codes.resize( m_rows * m_cols );
+  m_lower.resize( MaxBins * m_cols );
+  m_upper.resize( MaxBins * m_cols );
+  m_bins.resize( m_cols );
+  m_exact.resize( m_cols );
+
+  std::vector<double> sorted;
+  sorted.reserve( m_rows );
+
+  for( std::size_t j = 0; j < m_cols; ++j ){
+    const double * col = data.column( j );
+    double * lower = m_lower.data() + j * MaxBins;
+    double * upper = m_upper.data() + j * MaxBins;
+
+    // NaN breaks the ordering, it is set aside before sorting
+    sorted.clear();
+    for( std::size_t i = 0; i < m_rows; ++i )
+      if( ! std::isnan( col[i] ) )
+        sorted.push_back( col[i] );
+    std::sort( sorted.begin(), sorted.end() );
+
+    // the code past the value bins is kept for NaN
+    std::size_t n = sorted.size();
+    std::size_t col_bins = n < m_rows ? std::min( max_bins, MaxBins - 1 ) : max_bins;
+
+    std::size_t uniq = n ? 1 : 0;
+    for( std::size_t i = 1; i < n; ++i )
+      if( sorted[i] != sorted[i-1] )
+        ++uniq;
+    m_exact[j] = uniq <= col_bins;
+
+    // open a new bin on a change of value once the current
+    // bin reached its share of the rows
+    std::size_t bins = 0;
+    if( n ){
+      lower[0] = sorted[0];
+      for( std::size_t i = 1; i < n; ++i ){
+        if( sorted[i] == sorted[i-1] )
+          continue;
+        if( m_exact[j] || i >= ( bins + 1 ) * n / col_bins ){
+          upper[bins] = sorted[i-1];
+          lower[++bins] = sorted[i];
+        }
+      }
+      upper[bins] = sorted.back();
+      ++bins;
+    }
+    m_bins[j] = bins;
+
+    std::uint8_t * codes = m_codes.data() + j * m_rows;
+    for( std::size_t i = 0; i < m_rows; ++i )
+      codes[i] = std::isnan( col[i] ) ? (std::uint8_t)bins :
+                 (std::uint8_t)( std::lower_bound( upper, upper + bins, col[i] ) - upper );
+  }
+}
+
+std::size_t CBinnedDataset::rows( void ) const{
+  return m_rows;
+}
+
+std::size_t CBinnedDataset::cols( void ) const{
+  return m_cols;
+}
+
+bool CBinnedDataset::empty( void ) const{
+  return m_codes.empty();
+}
+
+bool CBinnedDataset::built_for( const CDataset & data ) const{
+  return ! empty() && data.rows() == m_rows && data.cols() == m_cols &&
+         data.column( 0 ) == m_source;
+}
+
+std::size_t CBinnedDataset::bins( std::size_t idx ) const{
+  return m_bins[idx];
+}
+
+bool CBinnedDataset::exact( std::size_t idx ) const{
+  return m_exact[idx];
+}
+
+const std::uint8_t * CBinnedDataset::codes( std::size_t idx ) const{
+  return m_codes.data() + idx * m_rows;
+}
+
+const double * CBinnedDataset::lower( std::size_t idx ) const{
+  return m_lower.data() + idx * MaxBins;
+}
+
+const double * CBinnedDataset::upper( std::size_t idx ) const{
+  return m_upper.data() + idx * MaxBins;
+}
+
+CDatasetStats::CDatasetStats( void ):
+    m_unique_total( 0 ), m_rows( 0 ), m_cols( 0 ), m_counted_unique( false ),
+    m_source( nullptr ){
+}
+
+CDatasetStats::CDatasetStats( const CDataset & data, CThreadPool * pool,
+                              bool count_unique ):
+    m_min( data.cols(), std::numeric_limits<double>::quiet_NaN() ),
+    m_max( data.cols(), std::numeric_limits<double>::quiet_NaN() ),
+    m_unique_total( 0 ), m_rows( data.rows() ), m_cols( data.cols() ),
+    m_counted_unique( count_unique ), m_source( nullptr ){
+
+  if( count_unique )
+    m_unique.assign( m_cols, 0 );
+
+  if( data.empty() )
+    return;
+
+  m_source = data.column( 0 );
+  std::vector<std::vector<double>> buffers( pool ? pool -> size() : 1 );
+
+  auto describe = [&]( std::size_t j, std::size_t worker ){
+    const double * col = data.column( j );
+
+    // NaN fails both compares, the first value sets min and max
+    for( std::size_t i = 0; i < m_rows; ++i ){
+      if( std::isnan( col[i] ) )
+        continue;
+      if( ! ( col[i] >= m_min[j] ) )
+        m_min[j] = col[i];
+      if( ! ( col[i] <= m_max[j] ) )
+        m_max[j] = col[i];
+    }
+
+    if( ! m_counted_unique )
+      return;
+
+    // NaN breaks the ordering, it is set aside before sorting
+    std::vector<double> & values = buffers[worker];
+    values.clear();
+    for( std::size_t i = 0; i < m_rows; ++i )
+      if( ! std::isnan( col[i] ) )
+        values.push_back( col[i] );
+    std::sort( values.begin(), values.end() );
+
+    m_unique[j] = std::unique( values.begin(), values.end() ) - values.begin();
+    if( values.size() < m_rows )
+      ++m_unique[j];
+  };
+
+  if( pool )
+    pool -> run( m_cols, describe );
+  else
+    for( std::size_t j = 0; j < m_cols; ++j )
+      describe( j, 0 );
+
+  m_unique_total = std::accumulate( m_unique.begin(), m_unique.end(),
+                                    std::size_t( 0 ) );
+}
+
+std::size_t CDatasetStats::cols( void ) const{
+  return m_cols;
+}
+
+bool CDatasetStats::empty( void ) const{
+  return m_source == nullptr;
+}
+
+bool CDatasetStats::built_for( const CDataset & data ) const{
+  return ! empty() && data.rows() == m_rows && data.cols() == m_cols &&
+         data.column( 0 ) == m_source;
+}
+
+bool CDatasetStats::counted_unique( void ) const{
+  return m_counted_unique;
+}
+
+std::size_t CDatasetStats::unique( std::size_t idx ) const{
+  return m_unique[idx];
+}
+
+std::size_t CDatasetStats::unique_total( void ) const{
+  return m_unique_total;
+}
+
+double CDatasetStats::min( std::size_t idx ) const{
+  return m_min[idx];
+}
+
+double CDatasetStats::max( std::size_t idx ) const{
+  return m_max[idx];
+}
+
+bool CDatasetStats::constant( std::size_t idx ) const{
+  // NaN for an all-NaN column, which is constant as well
+  return ! ( m_min[idx] < m_max[idx] );
+}
+
+#endif /*__datasetcpp__*/
@@ -0,0 +1,286 @@
+#ifndef __datasethpp__
+#define __datasethpp__
+
+#include <vector>
+#include <cstdint>
+#include <numeric>
+#include <memory>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+
+#include "./thread_pool.hpp"
+
+/**
+ * (C)Dataset stores the feature matrix in one contiguous,
+ * column-major buffer.
+ * - the nested vector form X[feature][row] maps to
+ *   m_data[feature * m_stride + row]
+ * - every column starts on an Alignment boundary, the rows
+ *   between m_rows and m_stride are padding filled with NaN,
+ *   so any comparison on them evaluates to false
+ */
+class CDataset{
+
+  public:
+    /** empty dataset */
+    CDataset( void );
+    /**
+     * @in: data in the nested vector form, X[feature][row]
+     * - copy the data into the contiguous buffer
+     * - all features need to have the same number of rows
+     */
+    explicit CDataset( const std::vector<std::vector<double>> & X );
+    /**
+     * @in: number of rows, number of features
+     * - allocate a dataset filled with zeros
+     */
+    explicit CDataset( std::size_t rows, std::size_t cols );
+    /** deep copy constructor */
+    CDataset( const CDataset & src );
+    /** move constructor, src is left empty */
+    CDataset( CDataset && src ) noexcept;
+    ~CDataset( void );
+    /** deep copy */
+    CDataset & operator=( const CDataset & src );
+    /** move assignment, src is left empty */
+    CDataset & operator=( CDataset && src ) noexcept;
+    /** return number of rows (samples) */
+    std::size_t rows( void ) const;
+    /** return number of columns (features) */
+    std::size_t cols( void ) const;
+    /** return distance between two consecutive columns */
+    std::size_t stride( void ) const;
+    /** return true if the dataset holds no data */
+    bool empty( void ) const;
+    /** return pointer to the first element of a given column */
+    const double * column( std::size_t idx ) const;
+    double * column( std::size_t idx );
+    /** return value at a given row and column */
+    double at( std::size_t row, std::size_t col ) const;
+    /** convert dataset back to the nested vector form */
+    std::vector<std::vector<double>> to_vector( void ) const;
+    /**
+     * @in: maximum number of categories
+     * - dictionary-encode every column with at most max_categories
+     *   unique values (and no NaN), the rows of such a column are
+     *   then also available as dense codes into the sorted list of
+     *   its unique values
+     * - 0 drops the encoding
+     */
+    void encode_categories( std::size_t max_categories );
+    /** return the limit the dataset was encoded with, 0 if not encoded */
+    std::size_t max_categories( void ) const;
+    /** return true if a given column is dictionary-encoded */
+    bool encoded( std::size_t idx ) const;
+    /** return sorted unique values (the dictionary) of a given column */
+    const std::vector<double> & categories( std::size_t idx ) const;
+    /** return pointer to the category codes of a given column */
+    const std::uint32_t * codes( std::size_t idx ) const;
+
+    /** alignment of every column in bytes */
+    const static std::size_t Alignment;
+
+  private:
+    double * m_buffer; // owned allocation
+    double * m_data;   // aligned begin of the first column
+    std::size_t m_rows;
+    std::size_t m_cols;
+    std::size_t m_stride;
+    std::size_t m_max_categories;
+    std::vector<std::vector<double>> m_categories; // dictionary per column,
+                                                   // empty if not encoded
+    std::vector<std::size_t> m_code_slot; // slot of a column in m_codes
+    std::vector<std::uint32_t> m_codes;   // codes of encoded columns,
+                                          // one slot of m_rows per column
+
+    /**
+      * @in: number of rows, number of features
+      * - allocate aligned buffer and set the metadata,
+      *   padding is filled with NaN
+      */
+    void allocate( std::size_t rows, std::size_t cols );
+    void release( void );
+};
+
+/**
+ * (C)SortedIndex keeps for every feature of a dataset the row
+ * indices ordered by value (argsort).
+ * - it is built once per fit, so that split search can visit
+ *   the rows of a feature in sorted order by a linear sweep
+ *   instead of sorting them on every call
+ * - rows with equal values keep their original order
+ * - NaN rows come last, in their original order
+ */
+class CSortedIndex{
+
+  public:
+    /** empty index */
+    CSortedIndex( void );
+    /**
+     * @in: dataset
+     * - argsort every column of the dataset
+     * - columns with at most rows / RankedRatio and MaxRankedValues
+     *   unique values (and no NaN) are also ranked, each row gets
+     *   the position of its value among the sorted unique values of
+     *   the column, columns are ranked in order until their unique
+     *   values reach MaxRankedTotal
+     * - the dataset may not have more than MaxRows rows
+     */
+    explicit CSortedIndex( const CDataset & data );
+    /** return number of rows */
+    std::size_t rows( void ) const;
+    /** return number of columns */
+    std::size_t cols( void ) const;
+    /** return true if no index is held */
+    bool empty( void ) const;
+    /**
+     * @in: dataset
+     * @out: true if the index was built for the given dataset
+     */
+    bool built_for( const CDataset & data ) const;
+    /** return pointer to the sorted row indices of a given column */
+    const std::uint32_t * column( std::size_t idx ) const;
+    /** return true if a given column is ranked */
+    bool ranked( std::size_t idx ) const;
+    /** return pointer to the ranks of the rows of a given column */
+    const std::uint16_t * ranks( std::size_t idx ) const;
+    /** return sorted unique values of a ranked column */
+    const std::vector<double> & values( std::size_t idx ) const;
+
+    /** maximum number of rows that can be indexed */
+    const static std::size_t MaxRows;
+    /** minimum ratio of rows to unique values of a ranked column */
+    const static std::size_t RankedRatio;
+    /** maximum number of unique values of a ranked column */
+    const static std::size_t MaxRankedValues;
+    /** maximum number of unique values of all ranked columns */
+    const static std::size_t MaxRankedTotal;
+
+  private:
+    std::vector<std::uint32_t> m_order; // column-major sorted rows
+    std::size_t m_rows;
+    std::size_t m_cols;
+    const double * m_source; // data of the indexed dataset
+    std::vector<std::vector<double>> m_values; // unique values per column,
+                                               // empty if not ranked
+    std::vector<std::size_t> m_rank_slot; // slot of a column in m_ranks
+    std::vector<std::uint16_t> m_ranks;   // ranks of ranked columns
+};
+
+/**
+ * (C)BinnedDataset quantizes every feature of a dataset into
+ * at most MaxBins bins, each row is then stored as an 8-bit
+ * bin code.
+ * - bins are cut at quantiles of the feature, equal values
+ *   always share a bin
+ * - a feature with at most max_bins unique values gets one bin
+ *   per value, such a feature is exact
+ * - lower(col)[b] and upper(col)[b] hold the smallest and the
+ *   largest value falling into bin b
+ * - NaN rows get the code bins(col), one past the value bins, they
+ *   have no bounds and no condition covers them, a column holding
+ *   NaN has at most MaxBins - 1 value bins
+ */
+class CBinnedDataset{
+
+  public:
+    /** empty binned dataset */
+    CBinnedDataset( void );
+    /**
+     * @in: dataset, maximum number of bins per feature
+     * - bin every column of the dataset
+     * - max_bins needs to be in [ 2, MaxBins ]
+     */
+    CBinnedDataset( const CDataset & data, std::size_t max_bins );
+    /** return number of rows */
+    std::size_t rows( void ) const;
+    /** return number of columns */
+    std::size_t cols( void ) const;
+    /** return true if no bins are held */
+    bool empty( void ) const;
+    /**
+     * @in: dataset
+     * @out: true if the bins were built for the given dataset
+     */
+    bool built_for( const CDataset & data ) const;
+    /** return number of value bins of a given column, code of NaN rows */
+    std::size_t bins( std::size_t idx ) const;
+    /** return true if every bin of a given column holds one value */
+    bool exact( std::size_t idx ) const;
+    /** return pointer to the bin codes of a given column */
+    const std::uint8_t * codes( std::size_t idx ) const;
+    /** return pointer to the lowest values of the bins of a given column */
+    const double * lower( std::size_t idx ) const;
+    /** return pointer to the highest values of the bins of a given column */
+    const double * upper( std::size_t idx ) const;
+
+    /** maximum number of bins per feature */
+    const static std::size_t MaxBins;
+
+  private:
+    std::vector<std::uint8_t> m_codes; // column-major bin codes
+    std::vector<double> m_lower;       // MaxBins values per column
+    std::vector<double> m_upper;       // MaxBins values per column
+    std::vector<std::size_t> m_bins;   // number of bins per column
+    std::vector<bool> m_exact;
+    std::size_t m_rows;
+    std::size_t m_cols;
+    const double * m_source; // data of the binned dataset
+};
+
+/**
+ * (C)DatasetStats holds per-column statistics of a dataset that
+ * the learners need more than once per fit.
+ * - min and max leave NaN out ( both are NaN for an all-NaN column )
+ * - a column is constant if min == max, or if it holds NaN only
+ * - unique counts need a sorted copy of every column, they are
+ *   computed only on request, NaN is counted as one more value
+ */
+class CDatasetStats{
+
+  public:
+    /** empty statistics */
+    CDatasetStats( void );
+    /**
+     * @in: dataset, thread pool ( or nullptr ), true if the unique
+     *      values are to be counted
+     * - columns are processed in parallel on the pool
+     */
+    explicit CDatasetStats( const CDataset & data, CThreadPool * pool = nullptr,
+                            bool count_unique = true );
+    /** return number of columns */
+    std::size_t cols( void ) const;
+    /** return true if no statistics are held */
+    bool empty( void ) const;
+    /**
+     * @in: dataset
+     * @out: true if the statistics were computed for the given dataset
+     */
+    bool built_for( const CDataset & data ) const;
+    /** return true if the unique values were counted */
+    bool counted_unique( void ) const;
+    /** return number of unique values of a given column */
+    std::size_t unique( std::size_t idx ) const;
+    /** return sum of unique values over all columns */
+    std::size_t unique_total( void ) const;
+    /** return the lowest value of a given column */
+    double min( std::size_t idx ) const;
+    /** return the highest value of a given column */
+    double max( std::size_t idx ) const;
+    /** return true if a given column is constant */
+    bool constant( std::size_t idx ) const;
+
+  private:
+    std::vector<std::size_t> m_unique;
+    std::vector<double> m_min;
+    std::vector<double> m_max;
+    std::size_t m_unique_total;
+    std::size_t m_rows;
+    std::size_t m_cols;
+    bool m_counted_unique;
+    const double * m_source; // data of the described dataset
+};
+
+#endif /*__datasethpp__*/
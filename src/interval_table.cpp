@@ -0,0 +1,130 @@
+#ifndef __interval_tablecpp__
+#define __interval_tablecpp__
+
+#include "./interval_table.hpp"
+
+/**
+ * @in: condition, lower bound (out), upper bound (out)
+ * @out: false if the condition is not { <=, >=, range }
+ */
+static bool interval_bounds( const CCondition & cond, double & lower, double & upper ){
+
+  const double inf = std::numeric_limits<double>::infinity();
+  auto vals = cond.get_values();
+
+  switch( cond.get_operator_code() ){
+    case CCondition::EOperator::LE:
+      lower = -inf;
+      upper = vals.front();
+      return true;
+    case CCondition::EOperator::GE:
+      lower = vals.front();
+      upper = inf;
+      return true;
+    case CCondition::EOperator::RANGE:
+      lower = vals[0];
+      upper = vals[1];
+      return true;
+    default:
+      return false;
+  }
+}
+
+CIntervalTable::CIntervalTable( void ):
+    m_upper( 1, std::numeric_limits<double>::quiet_NaN() ),
+    m_classes( 1, 0 ), m_feature( 0 ){
+}
+
+CIntervalTable::CIntervalTable( const CRuleset & ruleset ):
+    CIntervalTable(){
+
+  if( ! fits( ruleset ) )
+    throw std::invalid_argument( "Ruleset is not a list of intervals!" );
+
+  for( std::size_t r = 0; r < ruleset.size(); ++r ){
+    const CRule & rule = ruleset[r];
+    const CCondition & cond = rule[ *rule.o_cbegin() ];
+    double lower, upper;
+
+    interval_bounds( cond, lower, upper );
+    m_feature = cond.get_index();
+    m_lower.push_back( lower );
+    m_upper.push_back( upper );
+    m_classes.push_back( rule.predicted_class() );
+  }
+}
+
+bool CIntervalTable::fits( const CRuleset & ruleset ){
+
+  std::size_t feature = 0;
+  double prev_lower = 0, prev_upper = 0;
+
+  for( std::size_t r = 0; r < ruleset.size(); ++r ){
+    const CRule & rule = ruleset[r];
+    double lower, upper;
+
+    if( ! rule.shows_class() || rule.size() != 1 )
+      return false;
+
+    const CCondition & cond = rule[ *rule.o_cbegin() ];
+    if( ! interval_bounds( cond, lower, upper ) )
+      return false;
+    // NaN bounds fail every comparison below
+    if( ! r ){
+      feature = cond.get_index();
+      if( !( lower <= upper ) )
+        return false;
+    }
+    else if( cond.get_index() != feature ||
+             !( lower > prev_upper && lower > prev_lower && upper >= lower ) )
+      return false;
+
+    prev_lower = lower;
+    prev_upper = upper;
+  }
+
+  return true;
+}
+
+std::size_t CIntervalTable::size( void ) const{
+  return m_lower.size();
+}
+
+std::size_t CIntervalTable::feature( void ) const{
+  return m_feature;
+}
+
+std::size_t CIntervalTable::slot( double x ) const{
+
+  std::size_t n = m_lower.size();
+  if( ! n )
+    return 0;
+
+  // the loop runs log2( n ) times whatever x is and the comparison
+  // becomes a conditional move
+  const double * base = m_lower.data();
+  while( n > 1 ){
+    std::size_t half = n / 2;
+    base = base[half] <= x ? base + half : base;
+    n -= half;
+  }
+
+  return ( base - m_lower.data() ) + ( *base <= x );
+}
+
+std::size_t CIntervalTable::covering_rule( double x ) const{
+  std::size_t s = slot( x );
+  return x <= m_upper[s] ? s - 1 : size();
+}
+
+std::size_t CIntervalTable::predict_one( double x ) const{
+  std::size_t s = slot( x );
+  return x <= m_upper[s] ? m_classes[s] : m_classes[0];
+}
+
+void CIntervalTable::predict( const double * x, std::size_t n, std::size_t * out ) const{
+  for( std::size_t i = 0; i < n; ++i )
+    out[i] = predict_one( x[i] );
+}
+
+#endif /*__interval_tablecpp__*/
@@ -0,0 +1,75 @@
+#ifndef __interval_tablehpp__
+#define __interval_tablehpp__
+
+#include <vector>
+#include <limits>
+#include <stdexcept>
+#include "./dataset.hpp"
+#include "./ruleset.hpp"
+
+/**
+ * (C)IntervalTable is the form of a single-feature ruleset (as made
+ * by COneR) used for prediction.
+ * - every rule holds one { <=, >=, range } condition on the same
+ *   feature, the rules are sorted and disjoint, so at most one rule
+ *   covers a value and the decision list becomes a table of
+ *   intervals
+ * - m_lower keeps the lower bounds, a branchless binary search finds
+ *   the last interval starting at or below the value, its upper bound
+ *   decides whether it covers the value
+ * - all methods are const, it can be read by any number of threads
+ */
+class CIntervalTable{
+
+  public:
+    /** empty table */
+    CIntervalTable( void );
+    /**
+     * @in: ruleset
+     * - throws std::invalid_argument if the ruleset is not an interval
+     *   list, see fits()
+     */
+    explicit CIntervalTable( const CRuleset & ruleset );
+    /**
+     * @in: ruleset
+     * @out: true if every rule has a class set and a single
+     *       { <=, >=, range } condition on one feature, and every
+     *       rule starts above the end of the previous one
+     */
+    static bool fits( const CRuleset & ruleset );
+    /** return number of intervals (rules) */
+    std::size_t size( void ) const;
+    /** return index of the feature the rules read */
+    std::size_t feature( void ) const;
+    /**
+     * @in: value of the feature
+     * @out: index of the rule covering the value, size() if
+     *       no rule covers it
+     */
+    std::size_t covering_rule( double x ) const;
+    /**
+     * @in: value of the feature
+     * @out: class of the rule covering the value, 0 if no rule
+     *       covers it
+     */
+    std::size_t predict_one( double x ) const;
+    /**
+     * @in: values of the feature, number of values, output
+     * - out[i] receives predict_one( x[i] )
+     */
+    void predict( const double * x, std::size_t n, std::size_t * out ) const;
+
+  private:
+    std::vector<double> m_lower;
+    // one more entry than intervals, the entry 0 stands for values
+    // below the first interval: its upper bound is NaN, so it covers
+    // nothing, and its class is the class of uncovered values
+    std::vector<double> m_upper;
+    std::vector<std::size_t> m_classes;
+    std::size_t m_feature;
+
+    /** number of lower bounds <= x, 0 for NaN */
+    std::size_t slot( double x ) const;
+};
+
+#endif /*__interval_tablehpp__*/
@@ -0,0 +1,234 @@
+#ifndef __kernelscpp__
+#define __kernelscpp__
+
+#include "./kernels.hpp"
+
+#if ( defined( __GNUC__ ) || defined( __clang__ ) ) && \
+    ( defined( __x86_64__ ) || defined( __i386__ ) )
+  #define __kernels_x86__
+  #include <immintrin.h>
+#endif
+
+// scalar kernels, written branch-free so that the compiler
+// may vectorise them for the baseline instruction set
+
+static void le_mask_scalar( const double * col, std::size_t words, double upper,
+                            std::uint64_t * out ){
+  for( std::size_t w = 0; w < words; ++w, col += 64 ){
+    std::uint64_t bits = 0;
+    for( std::size_t b = 0; b < 64; ++b )
+      bits |= (std::uint64_t)( col[b] <= upper ) << b;
+    out[w] = bits;
+  }
+}
+
+static void ge_mask_scalar( const double * col, std::size_t words, double lower,
+                            std::uint64_t * out ){
+  for( std::size_t w = 0; w < words; ++w, col += 64 ){
+    std::uint64_t bits = 0;
+    for( std::size_t b = 0; b < 64; ++b )
+      bits |= (std::uint64_t)( col[b] >= lower ) << b;
+    out[w] = bits;
+  }
+}
+
+static void range_mask_scalar( const double * col, std::size_t words, double lower,
+                               double upper, std::uint64_t * out ){
+  for( std::size_t w = 0; w < words; ++w, col += 64 ){
+    std::uint64_t bits = 0;
+    for( std::size_t b = 0; b < 64; ++b )
+      bits |= (std::uint64_t)( ( col[b] >= lower ) & ( col[b] <= upper ) ) << b;
+    out[w] = bits;
+  }
+}
+
+static void in_mask_scalar( const double * col, std::size_t words,
+                            const std::vector<double> & values, std::uint64_t * out ){
+  for( std::size_t w = 0; w < words; ++w, col += 64 ){
+    std::uint64_t bits = 0;
+    for( const auto & val : values )
+      for( std::size_t b = 0; b < 64; ++b )
+        bits |= (std::uint64_t)( col[b] == val ) << b;
+    out[w] = bits;
+  }
+}
+
+#ifdef __kernels_x86__
+
+// AVX2, 4 doubles per comparison
+
+template<int Cmp>
+__attribute__(( target( "avx2" ) ))
+static void cmp_mask_avx2( const double * col, std::size_t words, double val,
+                           std::uint64_t * out ){
+  const __m256d v = _mm256_set1_pd( val );
+  for( std::size_t w = 0; w < words; ++w, col += 64 ){
+    std::uint64_t bits = 0;
+    for( std::size_t k = 0; k < 16; ++k ){
+      __m256d x = _mm256_loadu_pd( col + 4 * k );
+      bits |= (std::uint64_t)_mm256_movemask_pd( _mm256_cmp_pd( x, v, Cmp ) ) << ( 4 * k );
+    }
+    out[w] = bits;
+  }
+}
+
+__attribute__(( target( "avx2" ) ))
+static void range_mask_avx2( const double * col, std::size_t words, double lower,
+                             double upper, std::uint64_t * out ){
+  const __m256d lo = _mm256_set1_pd( lower );
+  const __m256d hi = _mm256_set1_pd( upper );
+  for( std::size_t w = 0; w < words; ++w, col += 64 ){
+    std::uint64_t bits = 0;
+    for( std::size_t k = 0; k < 16; ++k ){
+      __m256d x = _mm256_loadu_pd( col + 4 * k );
+      __m256d m = _mm256_and_pd( _mm256_cmp_pd( x, lo, _CMP_GE_OQ ),
+                                 _mm256_cmp_pd( x, hi, _CMP_LE_OQ ) );
+      bits |= (std::uint64_t)_mm256_movemask_pd( m ) << ( 4 * k );
+    }
+    out[w] = bits;
+  }
+}
+
+__attribute__(( target( "avx2" ) ))
+static void in_mask_avx2( const double * col, std::size_t words,
+                          const std::vector<double> & values, std::uint64_t * out ){
+  for( std::size_t w = 0; w < words; ++w, col += 64 ){
+    std::uint64_t bits = 0;
+    for( std::size_t k = 0; k < 16; ++k ){
+      __m256d x = _mm256_loadu_pd( col + 4 * k );
+      __m256d m = _mm256_setzero_pd();
+      for( const auto & val : values )
+        m = _mm256_or_pd( m, _mm256_cmp_pd( x, _mm256_set1_pd( val ), _CMP_EQ_OQ ) );
+      bits |= (std::uint64_t)_mm256_movemask_pd( m ) << ( 4 * k );
+    }
+    out[w] = bits;
+  }
+}
+
+// AVX-512, 8 doubles per comparison
+
+template<int Cmp>
+__attribute__(( target( "avx512f" ) ))
+static void cmp_mask_avx512( const double * col, std::size_t words, double val,
+                             std::uint64_t * out ){
+  const __m512d v = _mm512_set1_pd( val );
+  for( std::size_t w = 0; w < words; ++w, col += 64 ){
+    std::uint64_t bits = 0;
+    for( std::size_t k = 0; k < 8; ++k ){
+      __m512d x = _mm512_loadu_pd( col + 8 * k );
+      bits |= (std::uint64_t)_mm512_cmp_pd_mask( x, v, Cmp ) << ( 8 * k );
+    }
+    out[w] = bits;
+  }
+}
+
+__attribute__(( target( "avx512f" ) ))
+static void range_mask_avx512( const double * col, std::size_t words, double lower,
+                               double upper, std::uint64_t * out ){
+  const __m512d lo = _mm512_set1_pd( lower );
+  const __m512d hi = _mm512_set1_pd( upper );
+  for( std::size_t w = 0; w < words; ++w, col += 64 ){
+    std::uint64_t bits = 0;
+    for( std::size_t k = 0; k < 8; ++k ){
+      __m512d x = _mm512_loadu_pd( col + 8 * k );
+      __mmask8 m = _mm512_mask_cmp_pd_mask( _mm512_cmp_pd_mask( x, lo, _CMP_GE_OQ ),
+                                            x, hi, _CMP_LE_OQ );
+      bits |= (std::uint64_t)m << ( 8 * k );
+    }
+    out[w] = bits;
+  }
+}
+
+__attribute__(( target( "avx512f" ) ))
+static void in_mask_avx512( const double * col, std::size_t words,
+                            const std::vector<double> & values, std::uint64_t * out ){
+  for( std::size_t w = 0; w < words; ++w, col += 64 ){
+    std::uint64_t bits = 0;
+    for( std::size_t k = 0; k < 8; ++k ){
+      __m512d x = _mm512_loadu_pd( col + 8 * k );
+      __mmask8 m = 0;
+      for( const auto & val : values )
+        m |= _mm512_cmp_pd_mask( x, _mm512_set1_pd( val ), _CMP_EQ_OQ );
+      bits |= (std::uint64_t)m << ( 8 * k );
+    }
+    out[w] = bits;
+  }
+}
+
+#endif /*__kernels_x86__*/
+
+/**
+ * (C)KernelTable holds the kernels selected for the running CPU.
+ */
+struct CKernelTable{
+  void ( *le )( const double *, std::size_t, double, std::uint64_t * );
+  void ( *ge )( const double *, std::size_t, double, std::uint64_t * );
+  void ( *range )( const double *, std::size_t, double, double, std::uint64_t * );
+  void ( *in )( const double *, std::size_t, const std::vector<double> &,
+                std::uint64_t * );
+  const char * isa;
+
+  CKernelTable( void ):
+      le( le_mask_scalar ), ge( ge_mask_scalar ), range( range_mask_scalar ),
+      in( in_mask_scalar ), isa( "scalar" ){
+    #ifdef __kernels_x86__
+      __builtin_cpu_init();
+      if( __builtin_cpu_supports( "avx512f" ) ){
+        le = cmp_mask_avx512<_CMP_LE_OQ>;
+        ge = cmp_mask_avx512<_CMP_GE_OQ>;
+        range = range_mask_avx512;
+        in = in_mask_avx512;
+        isa = "avx512f";
+      }
+      else if( __builtin_cpu_supports( "avx2" ) ){
+        le = cmp_mask_avx2<_CMP_LE_OQ>;
+        ge = cmp_mask_avx2<_CMP_GE_OQ>;
+        range = range_mask_avx2;
+        in = in_mask_avx2;
+        isa = "avx2";
+      }
+    #endif
+  }
+};
+
+static const CKernelTable & kernel_table( void ){
+  // initialised once, thread-safe since C++11
+  static const CKernelTable table;
+  return table;
+}
+
+void le_mask( const double * col, std::size_t words, double upper,
+              std::uint64_t * out ){
+  kernel_table().le( col, words, upper, out );
+}
+
+void ge_mask( const double * col, std::size_t words, double lower,
+              std::uint64_t * out ){
+  kernel_table().ge( col, words, lower, out );
+}
+
+void range_mask( const double * col, std::size_t words, double lower,
+                 double upper, std::uint64_t * out ){
+  kernel_table().range( col, words, lower, upper, out );
+}
+
+void in_mask( const double * col, std::size_t words,
+              const std::vector<double> & values, std::uint64_t * out ){
+  kernel_table().in( col, words, values, out );
+}
+
+void code_mask( const std::uint32_t * codes, std::size_t words,
+                const std::uint64_t * categories, std::uint64_t * out ){
+  for( std::size_t w = 0; w < words; ++w, codes += 64 ){
+    std::uint64_t bits = 0;
+    for( std::size_t b = 0; b < 64; ++b )
+      bits |= ( ( categories[codes[b] >> 6] >> ( codes[b] & 63 ) ) & 1 ) << b;
+    out[w] = bits;
+  }
+}
+
+const char * kernels_isa( void ){
+  return kernel_table().isa;
+}
+
+#endif /*__kernelscpp__*/
@@ -0,0 +1,39 @@
+#ifndef __kernelshpp__
+#define __kernelshpp__
+
+#include <vector>
+#include <cstdint>
+
+/**
+ * Condition evaluation kernels.
+ * Every kernel scans `words` * 64 consecutive values of a column
+ * and writes one bit per value into out (bit b of out[w] belongs to
+ * col[w * 64 + b]), the bit is set if the value satisfies the
+ * condition. Comparisons with NaN are false, as in the scalar code.
+ * The implementation (AVX-512, AVX2 or scalar) is chosen once at
+ * runtime based on the CPU.
+ */
+
+/** col[i] <= upper */
+void le_mask( const double * col, std::size_t words, double upper,
+              std::uint64_t * out );
+/** col[i] >= lower */
+void ge_mask( const double * col, std::size_t words, double lower,
+              std::uint64_t * out );
+/** lower <= col[i] <= upper */
+void range_mask( const double * col, std::size_t words, double lower,
+                 double upper, std::uint64_t * out );
+/** col[i] is equal to one of the values */
+void in_mask( const double * col, std::size_t words,
+              const std::vector<double> & values, std::uint64_t * out );
+/**
+ * codes[i] has its bit set in the bitset of categories
+ * - a plain scalar lookup, it is used for dictionary-encoded
+ *   columns (see CDataset::encode_categories)
+ */
+void code_mask( const std::uint32_t * codes, std::size_t words,
+                const std::uint64_t * categories, std::uint64_t * out );
+/** return name of the selected implementation */
+const char * kernels_isa( void );
+
+#endif /*__kernelshpp__*/
@@ -26,6 +26,7 @@ CLogger::~CLogger( void ){
 }
 
 void CLogger::log( const std::string & message ){
+  std::lock_guard<std::mutex> lock( m_mutex );
   m_file << message << "\n";
   m_file.flush();
   if( m_to_term )
@@ -6,6 +6,7 @@
 #include <iostream>
 #include <fstream>
 #include <chrono>
+#include <mutex>
 
 class CLogger{
 
@@ -17,6 +18,7 @@ class CLogger{
   private:
     std::fstream m_file;
     bool m_to_term;
+    std::mutex m_mutex; // learners may log from worker threads
     
 };
 
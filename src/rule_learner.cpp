@@ -3,9 +3,84 @@
 
 #include "./rule_learner.hpp"
 
+CRulesetCoverage::CRulesetCoverage( const CRuleset & ruleset, const CDataset & X,
+                                    const std::vector<std::size_t> & y_true,
+                                    std::size_t positive_class ):
+    m_data( X ), m_predicts( positive_class ), m_labels( X.rows() ){
+
+  if( y_true.size() != X.rows() )
+    throw std::invalid_argument( "Input vector sizes differ!" );
+
+  for( std::size_t i = 0; i < y_true.size(); ++i )
+    if( y_true[i] )
+      m_labels.set( i );
+
+  for( std::size_t i = 0; i < ruleset.size(); ++i )
+    m_masks.push_back( rule_mask( ruleset[i] ) );
+}
+
+std::size_t CRulesetCoverage::size( void ) const{
+  return m_masks.size();
+}
+
+CCoverage CRulesetCoverage::rule_mask( const CRule & rule ) const{
+  return rule.covered_mask( m_data, CCoverage( m_data.rows(), true ) );
+}
+
+void CRulesetCoverage::replace( std::size_t idx, const CRule & rule ){
+  m_masks.at( idx ) = rule_mask( rule );
+}
+
+void CRulesetCoverage::erase( std::size_t idx ){
+  m_masks.erase( m_masks.begin() + idx );
+}
+
+void CRulesetCoverage::confusion_matrix( std::size_t & tn, std::size_t & fp,
+                                         std::size_t & fn, std::size_t & tp ) const{
+  count( std::numeric_limits<std::size_t>::max(), nullptr, tn, fp, fn, tp );
+}
+
+void CRulesetCoverage::confusion_matrix_without( std::size_t idx,
+                                                 std::size_t & tn, std::size_t & fp,
+                                                 std::size_t & fn, std::size_t & tp ) const{
+  count( idx, nullptr, tn, fp, fn, tp );
+}
+
+void CRulesetCoverage::confusion_matrix_with( std::size_t idx, const CCoverage & mask,
+                                              std::size_t & tn, std::size_t & fp,
+                                              std::size_t & fn, std::size_t & tp ) const{
+  count( idx, &mask, tn, fp, fn, tp );
+}
+
+void CRulesetCoverage::count( std::size_t idx, const CCoverage * mask,
+                              std::size_t & tn, std::size_t & fp,
+                              std::size_t & fn, std::size_t & tp ) const{
+
+  // rows predicted positive
+  CCoverage predicted( m_data.rows() );
+  if( m_predicts ){
+    for( std::size_t i = 0; i < m_masks.size(); ++i )
+      if( i != idx )
+        predicted |= m_masks[i];
+    if( mask )
+      predicted |= *mask;
+  }
+
+  std::size_t positive = predicted.count();
+  predicted &= m_labels;
+  tp = predicted.count();
+  fp = positive - tp;
+  fn = m_labels.count() - tp;
+  tn = m_data.rows() - tp - fp - fn;
+}
+
 CRuleLearner::CRuleLearner( void ):
     m_split_ratio( 2./3 ), m_categorical_max( 0 ), m_difference( 64 ),
-    m_prune_rules( true ), m_n_threads( 1 ){
+    m_prune_rules( true ), m_n_threads( 1 ), m_max_bins( 0 ),
+    m_sorted( std::make_shared<CSortedIndex>() ),
+    m_binned( std::make_shared<CBinnedDataset>() ),
+    m_stats( std::make_shared<CDatasetStats>() ),
+    m_pools( std::make_shared<CPoolSet>() ){
 
   std::random_device rand_dev;
   m_random_state = rand_dev();
@@ -19,11 +94,175 @@ CRuleLearner::CRuleLearner( double split_ratio, std::size_t random_state,
                             const std::string & pruning_metric ):
     m_split_ratio( split_ratio ), m_random_state( random_state ),
     m_categorical_max( categorical_max ), m_difference( difference ),
-    m_prune_rules( prune_rules ), m_n_threads( n_threads ),
-    m_rand_gen( random_state ){
+    m_prune_rules( prune_rules ), m_n_threads( n_threads ), m_max_bins( 0 ),
+    m_rand_gen( random_state ),
+    m_sorted( std::make_shared<CSortedIndex>() ),
+    m_binned( std::make_shared<CBinnedDataset>() ),
+    m_stats( std::make_shared<CDatasetStats>() ),
+    m_pools( std::make_shared<CPoolSet>() ){
   set_pruning_metric( pruning_metric );
 }
 
+CRuleLearner * CRuleLearner::clone( void ) const{
+  return nullptr;
+}
+
+bool CRuleLearner::uses_description_length( void ) const{
+  return false;
+}
+
+CRuleLearner::CFitScope::CFitScope( CRuleLearner & learner, const CDataset & X ):
+    m_learner( learner ), m_sorted( learner.m_sorted ),
+    m_binned( learner.m_binned ), m_stats( learner.m_stats ){
+
+  // the unique values are read by the description lengths only
+  if( ! m_stats -> built_for( X ) )
+    m_learner.m_stats = std::make_shared<CDatasetStats>( X, m_learner.thread_pool(),
+                                                         m_learner.uses_description_length() );
+  // datasets too large for 32-bit row indices are searched
+  // without the presorted index
+  if( m_learner.m_max_bins ){
+    if( ! m_binned -> built_for( X ) )
+      m_learner.m_binned = std::make_shared<CBinnedDataset>( X, m_learner.m_max_bins );
+  }
+  else if( X.rows() <= CSortedIndex::MaxRows && ! m_sorted -> built_for( X ) )
+    m_learner.m_sorted = std::make_shared<CSortedIndex>( X );
+}
+
+CRuleLearner::CFitScope::~CFitScope( void ){
+  m_learner.m_sorted = m_sorted;
+  m_learner.m_binned = m_binned;
+  m_learner.m_stats = m_stats;
+}
+
+const std::size_t CRuleLearner::CClassCounts::MaxValues = 1 << 20;
+
+CRuleLearner::CClassCounts::CClassCounts( const CRuleLearner & learner,
+                                          const CDataset & X ):
+    m_bins( X.cols(), nullptr ), m_codes( X.cols(), nullptr ),
+    m_ranks( X.cols(), nullptr ), m_offset( X.cols(), 0 ),
+    m_size( X.cols(), 0 ){
+
+  // the counts are 32-bit
+  if( X.rows() > CSortedIndex::MaxRows )
+    return;
+
+  bool histogram = learner.m_binned -> built_for( X );
+  bool sorted = learner.m_sorted -> built_for( X );
+  std::size_t total = 0;
+
+  for( std::size_t i = 0; i < X.cols(); ++i ){
+    std::size_t size = 0;
+    if( histogram )
+      size = learner.m_binned -> bins( i );
+    else if( X.encoded( i ) )
+      size = X.categories( i ).size();
+    else if( sorted && learner.m_sorted -> ranked( i ) )
+      size = learner.m_sorted -> values( i ).size();
+    // features past the budget are counted by the split search
+    if( ! size || total + size > MaxValues )
+      continue;
+
+    if( histogram )
+      m_bins[i] = learner.m_binned -> codes( i );
+    else if( X.encoded( i ) )
+      m_codes[i] = X.codes( i );
+    else
+      m_ranks[i] = learner.m_sorted -> ranks( i );
+    m_size[i] = size;
+    m_offset[i] = total;
+    // one more slot counts the NaN rows of a binned feature
+    total += histogram ? size + 1 : size;
+  }
+
+  m_pos.resize( total );
+  m_neg.resize( total );
+}
+
+bool CRuleLearner::CClassCounts::empty( void ) const{
+  return m_pos.empty();
+}
+
+bool CRuleLearner::CClassCounts::tracks( std::size_t idx ) const{
+  return m_size[idx];
+}
+
+std::size_t CRuleLearner::CClassCounts::values( std::size_t idx ) const{
+  return m_size[idx];
+}
+
+const std::uint32_t * CRuleLearner::CClassCounts::pos( std::size_t idx ) const{
+  return m_pos.data() + m_offset[idx];
+}
+
+const std::uint32_t * CRuleLearner::CClassCounts::neg( std::size_t idx ) const{
+  return m_neg.data() + m_offset[idx];
+}
+
+void CRuleLearner::CClassCounts::assign( const std::vector<std::size_t> & pos_rows,
+                                         const std::vector<std::size_t> & neg_rows ){
+  std::fill( m_pos.begin(), m_pos.end(), 0 );
+  std::fill( m_neg.begin(), m_neg.end(), 0 );
+  update( pos_rows, m_pos, true );
+  update( neg_rows, m_neg, true );
+}
+
+void CRuleLearner::CClassCounts::remove( const std::vector<std::size_t> & pos_rows,
+                                         const std::vector<std::size_t> & neg_rows ){
+  update( pos_rows, m_pos, false );
+  update( neg_rows, m_neg, false );
+}
+
+void CRuleLearner::CClassCounts::update( const std::vector<std::size_t> & rows,
+                                         std::vector<std::uint32_t> & counts,
+                                         bool add ){
+  // unsigned wrap-around makes the subtraction an addition of -1
+  const std::uint32_t delta = add ? 1 : -1;
+
+  for( std::size_t i = 0; i < m_size.size(); ++i ){
+    if( ! m_size[i] )
+      continue;
+    std::uint32_t * base = counts.data() + m_offset[i];
+    if( m_bins[i] ){
+      const std::uint8_t * codes = m_bins[i];
+      for( const auto & r : rows )
+        base[ codes[r] ] += delta;
+    }
+    else if( m_codes[i] ){
+      const std::uint32_t * codes = m_codes[i];
+      for( const auto & r : rows )
+        base[ codes[r] ] += delta;
+    }
+    else{
+      const std::uint16_t * ranks = m_ranks[i];
+      for( const auto & r : rows )
+        base[ ranks[r] ] += delta;
+    }
+  }
+}
+
+CThreadPool * CRuleLearner::CPoolSet::get( std::size_t n_threads ){
+
+  if( ! n_threads )
+    n_threads = std::max( 1u, std::thread::hardware_concurrency() );
+
+  std::lock_guard<std::mutex> lock( m_mutex );
+  std::unique_ptr<CThreadPool> & pool = m_pools[n_threads];
+  if( ! pool )
+    pool.reset( new CThreadPool( n_threads ) );
+  return pool.get();
+}
+
+CThreadPool * CRuleLearner::thread_pool( void ){
+  return thread_pool( m_n_threads );
+}
+
+CThreadPool * CRuleLearner::thread_pool( std::size_t n_threads ) const{
+  if( n_threads == 1 )
+    return nullptr;
+  return m_pools -> get( n_threads );
+}
+
 void CRuleLearner::confusion_matrix( const std::vector<std::size_t> & y_true,
                                      const std::vector<std::size_t> & y_pred,
                                      std::size_t & tn, std::size_t & fp,
@@ -46,7 +285,7 @@ void CRuleLearner::confusion_matrix( const std::vector<std::size_t> & y_true,
 
 void CRuleLearner::confusion_matrix( const CRuleset & ruleset,
                                      std::size_t start_index,
-                                     const std::vector<std::vector<double>> & X,
+                                     const CDataset & X,
                                      const std::vector<std::size_t> & pos,
                                      const std::vector<std::size_t> & neg, 
                                      std::size_t & tn, std::size_t & fp,
@@ -63,23 +302,19 @@ void CRuleLearner::confusion_matrix( const CRuleset & ruleset,
   else if( start_index >= ruleset.size() )
     throw std::invalid_argument( "Ruleset index out of range!" );
 
-  std::vector<std::size_t> pos_copy( pos );
-  std::vector<std::size_t> neg_copy( neg );
-
-  tp = pos_copy.size();
-  fp = neg_copy.size();
-  fn = tn = 0;
+  CCoverage pos_mask( X.rows(), pos );
+  CCoverage neg_mask( X.rows(), neg );
 
   for( std::size_t i = start_index; i < ruleset.size(); ++i ){
     const auto & rule = ruleset[i];
-    pos_copy = rule.not_covered_indices( X, pos_copy );
-    neg_copy = rule.not_covered_indices( X, neg_copy );
+    pos_mask.and_not( rule.covered_mask( X, pos_mask ) );
+    neg_mask.and_not( rule.covered_mask( X, neg_mask ) );
   }
 
-  tp -= pos_copy.size();
-  fn = pos_copy.size();
-  fp -= neg_copy.size();
-  tn = neg_copy.size();
+  fn = pos_mask.count();
+  tn = neg_mask.count();
+  tp = pos.size() - fn;
+  fp = neg.size() - tn;
 }
 
 double CRuleLearner::measure_accuracy( const std::vector<std::size_t> & y_true,
@@ -143,7 +378,7 @@ void CRuleLearner::data_split( const std::vector<std::size_t> & input_indices,
   std::sort( b.begin(), b.end() );
 }
 
-CRule CRuleLearner::grow_rule( const std::vector<std::vector<double>> & X,
+CRule CRuleLearner::grow_rule( const CDataset & X,
                                const std::vector<std::string> & feature_names,
                                const std::vector<std::size_t> & pos_grow,
                                const std::vector<std::size_t> & neg_grow ){
@@ -153,7 +388,7 @@ CRule CRuleLearner::grow_rule( const std::vector<std::vector<double>> & X,
   return r;
 }
 
-CRule CRuleLearner::grow_rule( const std::vector<std::vector<double>> & X,
+CRule CRuleLearner::grow_rule( const CDataset & X,
                                const std::vector<std::string> & feature_names,
                                const std::vector<std::size_t> & pos_grow,
                                const std::vector<std::size_t> & neg_grow,
@@ -161,34 +396,41 @@ CRule CRuleLearner::grow_rule( const std::vector<std::vector<double>> & X,
 
   CRule rule( r );
 
-  std::vector<std::size_t> pos_copy( pos_grow );
-  std::vector<std::size_t> neg_copy( neg_grow );
+  // rows covered by the rule, filtered in place as it grows
+  std::vector<std::size_t> pos_copy;
+  std::vector<std::size_t> neg_copy;
+  rule.covered_indices( X, pos_grow, pos_copy );
+  rule.covered_indices( X, neg_grow, neg_copy );
 
-  if( rule.size() ){
-    pos_copy = rule.covered_indices( X, pos_grow );
-    neg_copy = rule.covered_indices( X, neg_grow );
-  }
+  // class counts of the covered rows, updated as the rows shrink
+  CClassCounts counts( *this, X );
+  std::vector<std::size_t> pos_removed;
+  std::vector<std::size_t> neg_removed;
+  counts.assign( pos_copy, neg_copy );
 
   while( ! neg_copy.empty() ){
 
     CRule old_rule( rule );
-    CCondition * cond = find_literal( X, feature_names, pos_copy, neg_copy,
-                                      pos_copy.size(), neg_copy.size() );
+    CSplitCandidate best = find_split( X, feature_names.size(), pos_copy, neg_copy,
+                                       pos_copy.size(), neg_copy.size(), &counts );
     // check if the condition is not empty
-    if( ! cond ){
+    if( ! best.found ){
       #ifdef __verbose__
         __logger.log( "---- No better condition could have been found." );
       #endif
       break;
     }
 
+    // the condition is built only for the winning candidate
+    std::size_t index = best.index;
+    CCondition cond( feature_names[index], index, best.op, best.value );
+
     #ifdef __verbose__
-      __logger.log( "---- Found condition: " + (*cond).to_string() );
+      __logger.log( "---- Found condition: " + cond.to_string() );
     #endif
 
-    // add condition to the rule and delete it
-    rule.add_cond( CCondition( *cond ) );
-    delete cond;
+    // add condition to the rule
+    rule.add_cond( cond );
 
     // check whether the old_rule and rule do not match
     if( old_rule == rule ){
@@ -199,9 +441,24 @@ CRule CRuleLearner::grow_rule( const std::vector<std::vector<double>> & X,
       break;
     }
 
-    // change pos_copy and neg_copy to covered samples
-    pos_copy = rule.covered_indices( X, pos_copy );
-    neg_copy = rule.covered_indices( X, neg_copy );
+    // change pos_copy and neg_copy to covered samples, the rows
+    // already satisfy the other conditions, only the (possibly
+    // merged) condition of the feature needs to be applied
+    if( counts.empty() ){
+      rule[index].covered_indices( X, pos_copy, pos_copy );
+      rule[index].covered_indices( X, neg_copy, neg_copy );
+      continue;
+    }
+
+    rule[index].partition( X, pos_copy, pos_copy, pos_removed );
+    rule[index].partition( X, neg_copy, neg_copy, neg_removed );
+
+    // subtract the removed rows, or recount the remaining ones
+    // if there are fewer of them
+    if( pos_removed.size() + neg_removed.size() <= pos_copy.size() + neg_copy.size() )
+      counts.remove( pos_removed, neg_removed );
+    else
+      counts.assign( pos_copy, neg_copy );
   }
 
   #ifdef __verbose__
@@ -212,156 +469,339 @@ CRule CRuleLearner::grow_rule( const std::vector<std::vector<double>> & X,
   return rule;
 }
 
-CCondition * CRuleLearner::find_literal( const std::vector<std::vector<double>> & X,
+CCondition * CRuleLearner::find_literal( const CDataset & X,
                                          const std::vector<std::string> & feature_names,
                                          const std::vector<std::size_t> & pos_grow,
                                          const std::vector<std::size_t> & neg_grow,
                                          std::size_t pos_size, std::size_t neg_size ){
-  CCondition * best_cond = nullptr;
-  double best_gain = std::numeric_limits<double>::lowest();
-
-  for( std::size_t i = 0; i < feature_names.size(); ++i ){
-  
-    auto & X_row = X[i];
-
-    auto pos_uniq = unique_counts( X_row, pos_grow );
-    auto neg_uniq = unique_counts( X_row, neg_grow );
-    std::map<double,std::size_t> pos_sums; 
-    std::map<double,std::size_t> neg_sums; 
-    std::string used_op;
-
-    std::vector<std::string> ops;
-    if( m_categorical_max && pos_uniq.size() <= m_categorical_max )
-      ops.push_back( "in" );
-    else{
-      ops.push_back( "<=" );
-      ops.push_back( ">=" );
-    }
+  CSplitCandidate best = find_split( X, feature_names.size(), pos_grow, neg_grow,
+                                     pos_size, neg_size );
+  if( ! best.found )
+    return nullptr;
+  return new CCondition( feature_names[best.index], best.index, best.op, best.value );
+}
 
-    for( auto & op : ops ){
-      if( op == "in" ){
-        used_op = "in";
-        pos_sums = std::map<double,std::size_t>( std::move( pos_uniq ) ); 
-        for( auto & it : pos_sums ){
-          auto searched_uniq = neg_uniq.find( it.first );
-          if( searched_uniq != neg_uniq.end() )
-            neg_sums.insert( { it.first, searched_uniq -> second } );
-          else
-            neg_sums.insert( { it.first, 0 } );
-          // neg_sums[ it.first ] = neg_uniq[ it.first ];
-        }
+CSplitCandidate CRuleLearner::find_split( const CDataset & X,
+                                          std::size_t features,
+                                          const std::vector<std::size_t> & pos_grow,
+                                          const std::vector<std::size_t> & neg_grow,
+                                          std::size_t pos_size, std::size_t neg_size ){
+  return find_split( X, features, pos_grow, neg_grow, pos_size, neg_size, nullptr );
+}
+
+bool CRuleLearner::parallel_split( std::size_t rows, std::size_t features ) const{
+  // features are scanned in parallel only if there is enough
+  // work to outweigh waking up the workers
+  const std::size_t parallel_work = 1 << 15;
+  return m_n_threads != 1 && features > 1 && rows * features >= parallel_work;
+}
+
+CSplitCandidate CRuleLearner::find_split( const CDataset & X,
+                                          std::size_t features,
+                                          const std::vector<std::size_t> & pos_grow,
+                                          const std::vector<std::size_t> & neg_grow,
+                                          std::size_t pos_size, std::size_t neg_size,
+                                          const CClassCounts * counts ){
+
+  // a sweep over the presorted rows visits every row of the
+  // feature, sorting the active rows is cheaper once only
+  // a few of them remain
+  std::size_t active = pos_grow.size() + neg_grow.size();
+  bool sweep = ! m_binned -> built_for( X ) && m_sorted -> built_for( X ) &&
+               X.rows() < active * std::log2( active + 1 );
+
+  // 0 - inactive row, 1 - positive row, 2 - negative row
+  std::vector<unsigned char> labels;
+  if( sweep ){
+    labels.assign( X.rows(), 0 );
+    for( const auto & i : pos_grow )
+      labels[i] = 1;
+    for( const auto & i : neg_grow )
+      labels[i] = 2;
+  }
+
+  CThreadPool * pool = nullptr;
+  if( parallel_split( sweep ? X.rows() : active, features ) )
+    pool = thread_pool();
+  std::size_t workers = pool ? pool -> size() : 1;
+
+  // every worker keeps its own best candidate
+  std::vector<CSplitScratch> scratch( workers );
+  std::vector<CSplitCandidate> bests( workers );
+
+  auto scan = [&]( std::size_t i, std::size_t w ){
+    scan_feature( X, i, pos_grow, neg_grow, pos_size, neg_size,
+                  sweep, labels, counts, scratch[w], bests[w] );
+  };
+
+  if( pool )
+    pool -> run( features, scan );
+  else
+    for( std::size_t i = 0; i < features; ++i )
+      scan( i, 0 );
+
+  CSplitCandidate best;
+  for( const auto & x : bests )
+    if( best.worse_than( x ) )
+      best = x;
+
+  return best;
+
+}
+
+void CRuleLearner::scan_feature( const CDataset & X, std::size_t index,
+                                 const std::vector<std::size_t> & pos_grow,
+                                 const std::vector<std::size_t> & neg_grow,
+                                 std::size_t pos_size, std::size_t neg_size,
+                                 bool sweep, const std::vector<unsigned char> & labels,
+                                 const CClassCounts * counts,
+                                 CSplitScratch & scratch, CSplitCandidate & best ) const{
+
+  const double * X_row = X.column( index );
+  auto & values = scratch.values;
+  auto & lower_values = scratch.lower_values;
+  auto & pos_counts = scratch.pos_counts;
+  auto & neg_counts = scratch.neg_counts;
+  auto & pos_hist = scratch.pos_hist;
+  auto & neg_hist = scratch.neg_hist;
+  auto & pairs = scratch.pairs;
+
+  values.clear();
+  lower_values.clear();
+  pos_counts.clear();
+  neg_counts.clear();
+
+  // binned features are counted through fixed-size histograms
+  bool histogram = m_binned -> built_for( X );
+  bool encoded = ! histogram && X.encoded( index );
+
+  // tracked counts are read as they are, unless the feature has
+  // so many values that sorting the samples is cheaper
+  std::size_t active = pos_grow.size() + neg_grow.size();
+  bool tracked = counts && counts -> tracks( index ) &&
+                 ( histogram || encoded ||
+                   counts -> values( index ) <= active * std::log2( active + 1 ) );
+
+  if( tracked ){
+    const std::uint32_t * pos = counts -> pos( index );
+    const std::uint32_t * neg = counts -> neg( index );
+    std::size_t size = counts -> values( index );
+    const double * upper = histogram ? m_binned -> upper( index ) :
+                           encoded ? X.categories( index ).data() :
+                           m_sorted -> values( index ).data();
+
+    for( std::size_t c = 0; c < size; ++c )
+      if( pos[c] || neg[c] ){
+        if( histogram )
+          lower_values.push_back( m_binned -> lower( index )[c] );
+        values.push_back( upper[c] );
+        pos_counts.push_back( pos[c] );
+        neg_counts.push_back( neg[c] );
       }
-      else if( op == "<=" ){
-        used_op = "<=";
-        pos_sums = std::map<double,std::size_t>( std::move( pos_uniq ) );
-        map_cum_sum_ip( pos_sums.begin(), pos_sums.end() );
-        map_cum_sum_ip( neg_uniq.begin(), neg_uniq.end() );
-
-        for( auto & it : pos_sums ){
-          auto searched_uniq = neg_uniq.upper_bound( it.first );
-          if( searched_uniq == neg_uniq.begin() )
-            // if searched points to .begin(), neg_uniq does
-            // not contain any values `<= x`.
-            // neg_sums[ it.first ] = 0;
-            neg_sums.insert( { it.first, 0 } );
-          else{
-            // the iterator needs to be decremented as the
-            // value found (searched) is the first value
-            // after the searched value
-            --searched_uniq;
-            // neg_sums[ it.first ] = searched_uniq -> second;
-            neg_sums.insert( { it.first, searched_uniq -> second } );
-          }
-        }
+  }
+  else if( histogram ){
+    const std::uint8_t * codes = m_binned -> codes( index );
+    const double * lower = m_binned -> lower( index );
+    const double * upper = m_binned -> upper( index );
+    std::size_t bins = m_binned -> bins( index );
+
+    // the last slot counts the NaN rows, no condition covers them
+    pos_hist.assign( bins + 1, 0 );
+    neg_hist.assign( bins + 1, 0 );
+    for( const auto & j : pos_grow )
+      ++pos_hist[ codes[j] ];
+    for( const auto & j : neg_grow )
+      ++neg_hist[ codes[j] ];
+
+    for( std::size_t b = 0; b < bins; ++b )
+      if( pos_hist[b] || neg_hist[b] ){
+        lower_values.push_back( lower[b] );
+        values.push_back( upper[b] );
+        pos_counts.push_back( pos_hist[b] );
+        neg_counts.push_back( neg_hist[b] );
       }
-      else if( op == ">=" ){
-        used_op = ">=";
-        pos_sums = std::map<double,std::size_t>( std::move( pos_uniq ) );
-        map_cum_sum_ip( pos_sums.rbegin(), pos_sums.rend() );
-        map_cum_sum_ip( neg_uniq.rbegin(), neg_uniq.rend() );
-
-        for( auto & it : pos_sums ){
-          auto searched_uniq = neg_uniq.lower_bound( it.first );
-          if( searched_uniq == neg_uniq.end() )
-            // if we reached .end() then there are no values `>= x`.
-            // neg_sums[ it.first ] = 0;
-            neg_sums.insert( { it.first, 0 } );
-          else
-            // neg_sums[ it.first ] = searched -> second;
-            neg_sums.insert( { it.first, searched_uniq -> second } );
-        }
+  }
+  else if( encoded ){
+    // dictionary-encoded features are counted per category,
+    // the dictionary is sorted, so no sort is needed
+    const std::uint32_t * codes = X.codes( index );
+    const std::vector<double> & categories = X.categories( index );
+
+    pos_hist.assign( categories.size(), 0 );
+    neg_hist.assign( categories.size(), 0 );
+    for( const auto & j : pos_grow )
+      ++pos_hist[ codes[j] ];
+    for( const auto & j : neg_grow )
+      ++neg_hist[ codes[j] ];
+
+    for( std::size_t c = 0; c < categories.size(); ++c )
+      if( pos_hist[c] || neg_hist[c] ){
+        values.push_back( categories[c] );
+        pos_counts.push_back( pos_hist[c] );
+        neg_counts.push_back( neg_hist[c] );
       }
-      // proceed if both sums are non-empty
-      if( ! pos_sums.empty() && ! neg_sums.empty() )
-        foil_metric( pos_sums, neg_sums, pos_size, neg_size, feature_names[i],
-                     i, used_op, best_gain, best_cond );
+  }
+  else if( sweep ){
+    const std::uint32_t * order = m_sorted -> column( index );
+    for( std::size_t j = 0; j < X.rows(); ++j ){
+      auto & label = labels[ order[j] ];
+      if( ! label )
+        continue;
+      double val = X_row[ order[j] ];
+      // NaN rows are set apart, no condition covers them
+      if( std::isnan( val ) )
+        break;
+      if( values.empty() || values.back() != val ){
+        values.push_back( val );
+        pos_counts.push_back( 0 );
+        neg_counts.push_back( 0 );
+      }
+      if( label == 1 )
+        ++pos_counts.back();
+      else
+        ++neg_counts.back();
+    }
+  }
+  else{
+    // NaN rows are set apart, no condition covers them
+    pairs.clear();
+    for( const auto & j : pos_grow )
+      if( ! std::isnan( X_row[j] ) )
+        pairs.push_back( { X_row[j], 1 } );
+    for( const auto & j : neg_grow )
+      if( ! std::isnan( X_row[j] ) )
+        pairs.push_back( { X_row[j], 2 } );
+    std::sort( pairs.begin(), pairs.end() );
+    for( const auto & x : pairs ){
+      if( values.empty() || values.back() != x.first ){
+        values.push_back( x.first );
+        pos_counts.push_back( 0 );
+        neg_counts.push_back( 0 );
+      }
+      if( x.second == 1 )
+        ++pos_counts.back();
+      else
+        ++neg_counts.back();
     }
   }
 
-  return best_cond;
+  if( histogram )
+    evaluate_counts( lower_values, values, pos_counts, neg_counts,
+                     m_binned -> exact( index ), pos_size, neg_size,
+                     index, best );
+  else
+    evaluate_counts( values, values, pos_counts, neg_counts, true,
+                     pos_size, neg_size, index, best );
+}
 
+/**
+ * @in: number of positive and negative samples covered by a condition,
+ *      log of the positive share before the condition
+ * @out: FOIL information gain of the condition
+ */
+static double foil_gain( std::size_t pos, std::size_t neg, double old_log ){
+  double new_log = std::log( (double) pos / ( pos + neg ) );
+  return pos * ( new_log - old_log );
 }
 
-void CRuleLearner::foil_metric( const std::map<double,std::size_t> & pos_sums,
-                                const std::map<double,std::size_t> & neg_sums,
-                                std::size_t pos_size, std::size_t neg_size,
-                                const std::string & feature, std::size_t index,
-                                const std::string & m_op, double & best_gain,
-                                CCondition *& best_cond ) const{
-  auto it_pos = pos_sums.begin();
-  auto it_neg = neg_sums.begin();
+void CRuleLearner::evaluate_counts( const std::vector<double> & lower,
+                                    const std::vector<double> & upper,
+                                    const std::vector<std::size_t> & pos_counts,
+                                    const std::vector<std::size_t> & neg_counts,
+                                    bool exact, std::size_t pos_size, std::size_t neg_size,
+                                    std::size_t index, CSplitCandidate & best ) const{
+  // candidates are the values that occur in positive samples
+  std::size_t pos_uniq = 0, pos_total = 0, neg_total = 0;
+  for( std::size_t j = 0; j < pos_counts.size(); ++j ){
+    if( pos_counts[j] )
+      ++pos_uniq;
+    pos_total += pos_counts[j];
+    neg_total += neg_counts[j];
+  }
+
+  if( ! pos_uniq )
+    return;
 
   double old_log = std::log( (double)pos_size / ( pos_size + neg_size ) );
 
-  for( ; it_pos != pos_sums.end() && it_neg != neg_sums.end(); ++it_pos, ++it_neg ){
-    auto & pos = it_pos -> second;
-    auto & neg = it_neg -> second;
-    double new_log = std::log( (double) pos / ( pos + neg ) );
-    double foil = pos * ( new_log - old_log );
-
-    if( foil > best_gain ){
-      best_gain = foil;
-      
-      if( best_cond )
-        delete best_cond;
-      best_cond = new CCondition( feature, index, m_op, it_pos -> first );
-    }
+  if( exact && m_categorical_max && pos_uniq <= m_categorical_max ){
+    for( std::size_t j = 0; j < upper.size(); ++j )
+      if( pos_counts[j] )
+        best.offer( foil_gain( pos_counts[j], neg_counts[j], old_log ),
+                    index, CCondition::EOperator::IN, upper[j] );
+    return;
+  }
+
+  // a single sweep over the groups, `<= upper[j]` covers the groups
+  // up to j (prefix sums), `>= lower[j]` covers the groups from j on
+  // (totals minus the prefix sums before j)
+  CSplitCandidate le, ge;
+  std::size_t pos_cum = 0, neg_cum = 0;
+  for( std::size_t j = 0; j < upper.size(); ++j ){
+    if( pos_counts[j] )
+      ge.offer( foil_gain( pos_total - pos_cum, neg_total - neg_cum, old_log ),
+                index, CCondition::EOperator::GE, lower[j] );
+    pos_cum += pos_counts[j];
+    neg_cum += neg_counts[j];
+    if( pos_counts[j] )
+      le.offer( foil_gain( pos_cum, neg_cum, old_log ),
+                index, CCondition::EOperator::LE, upper[j] );
   }
+
+  // all `<=` candidates are considered before the `>=` ones
+  if( le.found )
+    best.offer( le.gain, le.index, le.op, le.value );
+  if( ge.found )
+    best.offer( ge.gain, ge.index, ge.op, ge.value );
 }
 
 CRule CRuleLearner::prune_rule( const CRule & old_rule,
-                                const std::vector<std::vector<double>> & X,
+                                const CDataset & X,
                                 const std::vector<std::size_t> & pos_prune,
                                 const std::vector<std::size_t> & neg_prune ){
-  double best_val = m_pruning_metric( X, old_rule, pos_prune, neg_prune );
-  auto learned_order = old_rule.learned_order();
-  CRule r( old_rule );
+  // covered positive and negative rows of the rule truncated to its
+  // first k learned conditions, k = 0 .. size, each prefix filters
+  // the rows of the previous one
+  std::size_t P = pos_prune.size(), N = neg_prune.size();
+  std::vector<std::size_t> p_prefix( 1, P ), n_prefix( 1, N );
+  std::vector<std::size_t> pos( pos_prune ), neg( neg_prune );
+  for( auto it = old_rule.o_cbegin(); it != old_rule.o_cend(); ++it ){
+    old_rule[*it].covered_indices( X, pos, pos );
+    old_rule[*it].covered_indices( X, neg, neg );
+    p_prefix.push_back( pos.size() );
+    n_prefix.push_back( neg.size() );
+  }
 
-  for( auto it = old_rule.o_crbegin(); it != old_rule.o_crend(); ++it ){
-    CRule new_rule( r );
-    new_rule.pop_back();
+  std::size_t k = old_rule.size();
+  double best_val = m_pruning_metric( P, N, p_prefix[k], n_prefix[k] );
+  std::size_t best_k = k;
 
-    double new_val = m_pruning_metric( X, new_rule, pos_prune, neg_prune );
+  // drop the last learned conditions while the metric improves
+  for( ; k-- > 0; ){
+    double new_val = m_pruning_metric( P, N, p_prefix[k], n_prefix[k] );
     #ifdef __verbose__
       __logger.log( "---- Old acc: " + std::to_string( best_val ) +
                     ", new acc: " + std::to_string( new_val ) +
                     ", pos_prune size: " + std::to_string( pos_prune.size() ) +
                     ", neg_prune size: " + std::to_string( neg_prune.size() ) );
     #endif
-    if( new_rule.size() && new_val > best_val ){
+    if( k && new_val > best_val ){
       best_val = new_val;
-      r = new_rule;
+      best_k = k;
     }
     else
       break;
-
   }
 
+  CRule r( old_rule );
+  while( r.size() > best_k )
+    r.pop_back();
+
   return r;
 
 }
 
-double CRuleLearner::rule_error( const std::vector<std::vector<double>> & X,
+double CRuleLearner::rule_error( const CDataset & X,
                                  const CRule & rule,
                                  const std::vector<std::size_t> & pos_prune,
                                  const std::vector<std::size_t> & neg_prune ) const{
@@ -377,37 +817,110 @@ double CRuleLearner::rule_error( const std::vector<std::vector<double>> & X,
 
 std::vector<std::size_t> CRuleLearner::predict(
                         const CRuleset & ruleset,
-                        const std::vector<std::vector<double>> & X,
+                        const CDataset & X,
                         std::size_t positive_class ) const{
+  return predict( ruleset, X, positive_class, m_n_threads );
+}
 
-  if( ! X.size() )
+std::vector<std::size_t> CRuleLearner::predict(
+                        const CRuleset & ruleset,
+                        const CDataset & X,
+                        std::size_t positive_class,
+                        std::size_t n_threads ) const{
+
+  if( ! X.cols() )
     throw std::invalid_argument( "Empty data!" );
 
-  std::vector<std::size_t> predicted( X.front().size(), 0 );
-  std::vector<std::size_t> indices( X.front().size() );
-  std::iota( indices.begin(), indices.end(), 0 );
+  CCompiledRuleset compiled( ruleset );
+  // every rule predicts the positive class
+  std::vector<std::size_t> classes( compiled.size(), positive_class );
+  classes.push_back( 0 );
 
-  for( std::size_t i = 0; i < ruleset.size(); ++i ){
-    auto covered = ruleset[i].covered_indices( X, indices ); 
-    for( auto & j : covered )
-      predicted[j] = positive_class;
-    indices = ruleset[i].not_covered_indices( X, indices );
-  }
+  return predict_rows( compiled, classes, X, n_threads );
+}
+
+std::vector<std::size_t> CRuleLearner::predict_rows( const CCompiledRuleset & compiled,
+                                                     const std::vector<std::size_t> & classes,
+                                                     const CDataset & X,
+                                                     std::size_t n_threads ) const{
+
+  if( compiled.features() > X.cols() )
+    throw std::invalid_argument( "Ruleset uses more features than the data has!" );
+
+  std::vector<std::size_t> predicted( X.rows() );
+
+  for_row_chunks( X.rows(), n_threads, [&]( std::size_t first, std::size_t last ){
+    std::vector<std::uint32_t> rules( CCompiledRuleset::BlockRows );
+    for( std::size_t i = first; i < last; i += rules.size() ){
+      std::size_t end = std::min( last, i + rules.size() );
+      compiled.covering_rules( X, i, end, rules.data() );
+      for( std::size_t j = i; j < end; ++j )
+        predicted[j] = classes[ rules[j - i] ];
+    }
+  } );
 
   return predicted;
 }
 
+void CRuleLearner::for_row_chunks( std::size_t rows, std::size_t n_threads,
+                                   const std::function<void( std::size_t, std::size_t )> & fn ) const{
+
+  const std::size_t tile = CCompiledRuleset::BlockRows;
+  std::size_t tiles = ( rows + tile - 1 ) / tile;
+
+  CThreadPool * pool = tiles > 1 ? thread_pool( n_threads ) : nullptr;
+  std::size_t workers = pool ? pool -> size() : 1;
+
+  // a few chunks per worker even out uneven rules
+  std::size_t chunks = std::min( tiles, workers * 4 );
+  std::size_t chunk_tiles = chunks ? ( tiles + chunks - 1 ) / chunks : 0;
+  if( chunk_tiles )
+    chunks = ( tiles + chunk_tiles - 1 ) / chunk_tiles;
+
+  auto chunk = [&]( std::size_t c, std::size_t ){
+    std::size_t first = c * chunk_tiles * tile;
+    fn( first, std::min( rows, first + chunk_tiles * tile ) );
+  };
+
+  if( pool )
+    pool -> run( chunks, chunk );
+  else
+    for( std::size_t c = 0; c < chunks; ++c )
+      chunk( c, 0 );
+}
+
 void CRuleLearner::set_pruning_metric( const std::string & metric ){
+  // the overloads on counts
+  typedef double ( *metric_fn )( std::size_t, std::size_t, std::size_t, std::size_t );
   if( metric == "IREP_default" )
-    m_pruning_metric = IREP_pruning_metric;
+    m_pruning_metric = static_cast<metric_fn>( IREP_pruning_metric );
   else if( metric == "RIPPER_default" )
-    m_pruning_metric = RIPPER_pruning_metric;
+    m_pruning_metric = static_cast<metric_fn>( RIPPER_pruning_metric );
   else
     throw std::runtime_error( "Invalid pruning metric!" );
 }
 
+double CRuleLearner::pruning_metric( const CDataset & X,
+                                     const CRule & rule,
+                                     const std::vector<std::size_t> & pos_prune,
+                                     const std::vector<std::size_t> & neg_prune ) const{
+  std::vector<std::size_t> covered;
+  rule.covered_indices( X, pos_prune, covered );
+  std::size_t p = covered.size();
+  rule.covered_indices( X, neg_prune, covered );
+  std::size_t n = covered.size();
+  return m_pruning_metric( pos_prune.size(), neg_prune.size(), p, n );
+}
+
+void CRuleLearner::set_histogram_bins( std::size_t max_bins ){
+  if( max_bins == 1 || max_bins > CBinnedDataset::MaxBins )
+    throw std::invalid_argument( "Invalid number of bins!" );
+
+  m_max_bins = max_bins;
+}
+
 double CRuleLearner::total_description_length( const CRuleset & ruleset,
-                                               const std::vector<std::vector<double>> & X,
+                                               const CDataset & X,
                                                const std::vector<std::size_t> & y_true,
                                                std::size_t positive_class ) const{
   std::size_t conditions_count = unique_conditions( X ); 
@@ -415,7 +928,7 @@ double CRuleLearner::total_description_length( const CRuleset & ruleset,
 }
 
 double CRuleLearner::total_description_length( const CRuleset & ruleset,
-                                               const std::vector<std::vector<double>> & X,
+                                               const CDataset & X,
                                                const std::vector<std::size_t> & y_true,
                                                std::size_t positive_class,
                                                std::size_t conditions_count ) const{
@@ -429,6 +942,20 @@ double CRuleLearner::total_description_length( const CRuleset & ruleset,
   return DL;
 }
 
+double CRuleLearner::total_description_length( const CRuleset & ruleset,
+                                               std::size_t conditions_count,
+                                               std::size_t tn, std::size_t fp,
+                                               std::size_t fn, std::size_t tp ) const{
+  double DL = 0.;
+
+  for( std::size_t i = 0; i < ruleset.size(); ++i )
+    DL += rule_bits( ruleset[i], conditions_count );
+
+  DL += exception_bits( tn, fp, fn, tp );
+
+  return DL;
+}
+
 double CRuleLearner::rule_bits( const CRule & rule, std::size_t conditions_count ) const{
 
   std::size_t k = rule.size();
@@ -446,7 +973,7 @@ double CRuleLearner::rule_bits( const CRule & rule, std::size_t conditions_count
 }
 
 double CRuleLearner::exception_bits( const CRuleset & ruleset,
-                                     const std::vector<std::vector<double>> & X,
+                                     const CDataset & X,
                                      const std::vector<std::size_t> & y_true,
                                      std::size_t positive_class ) const{
   auto predicted = predict( ruleset, X, positive_class );
@@ -458,17 +985,211 @@ double CRuleLearner::exception_bits( const CRuleset & ruleset,
 
 double CRuleLearner::exception_bits( std::size_t tn, std::size_t fp,
                                      std::size_t fn, std::size_t tp ) const{
-  return Slog_C( tp + fp, fp ) + Slog_C( tn + fn, fn );
+  return log_C( tp + fp, fp ) + log_C( tn + fn, fn );
 }
 
-std::size_t CRuleLearner::unique_conditions( const std::vector<std::vector<double>> & X ) const{
+double CRuleLearner::exception_bits( const CConfusion & confusion ) const{
+  return exception_bits( confusion.tn, confusion.fp, confusion.fn, confusion.tp );
+}
+
+std::size_t CRuleLearner::unique_conditions( const CDataset & X ) const{
+  // computed once per fit of the learners using description lengths
+  if( m_stats -> built_for( X ) && m_stats -> counted_unique() )
+    return m_stats -> unique_total();
+
+  return CDatasetStats( X ).unique_total();
+}
+
+CRuleset CRuleLearner::fit( const std::vector<std::vector<double>> & X,
+                            const std::vector<std::size_t> & Y,
+                            const std::vector<std::string> & feature_names,
+                            std::size_t positive_class ){
+  // categorical features are dictionary-encoded on the way in
+  CDataset data( X );
+  data.encode_categories( m_categorical_max );
+  return fit( data, Y, feature_names, positive_class );
+}
+
+CRuleset CRuleLearner::fit_multiclass( const CDataset & X,
+                                       const std::vector<std::size_t> & Y,
+                                       const std::vector<std::string> & feature_names ){
+
+  if( ! X.cols() || Y.empty() )
+    throw std::invalid_argument( "Input vector is empty!" );
+  else if( X.rows() != Y.size() )
+    throw std::invalid_argument( "Input vector sizes differ!" );
+
+  // classes by frequency, rarest first, ties by the class
+  std::map<std::size_t,std::size_t> frequency;
+  for( const auto & y : Y )
+    ++frequency[y];
+  std::vector<std::pair<std::size_t,std::size_t>> classes;
+  for( const auto & x : frequency )
+    classes.push_back( { x.second, x.first } );
+  std::sort( classes.begin(), classes.end() );
+
+  CFitScope scope( *this, X );
+  CThreadPool * pool = thread_pool();
+  std::vector<CRuleset> rulesets( classes.size() - 1 );
+  // one copy of the learner per class, a learner that cannot be
+  // copied learns the classes one at a time itself
+  std::vector<std::unique_ptr<CRuleLearner>> learners( rulesets.size() );
+  for( auto & x : learners )
+    x.reset( clone() );
+  bool copied = learners.empty() || learners[0];
+
+  auto learn = [&]( std::size_t k, std::size_t ){
+    std::size_t pr_class = classes[k].second;
+    std::vector<std::size_t> labels( Y.size() );
+    for( std::size_t i = 0; i < Y.size(); ++i )
+      labels[i] = Y[i] == pr_class;
+
+    CRuleLearner & learner = copied ? *learners[k] : *this;
+    CRuleset binary = learner.fit( X, labels, feature_names, 1 );
+
+    // rules predicting the class get it as their predicted class
+    for( std::size_t i = 0; i < binary.size(); ++i ){
+      if( binary[i].shows_class() && ! binary[i].predicts_class( 1 ) )
+        continue;
+      CRule rule( pr_class, true );
+      for( auto it = binary[i].o_cbegin(); it != binary[i].o_cend(); ++it )
+        rule.add_cond( binary[i][*it] );
+      rulesets[k].add_rule( rule );
+    }
+  };
 
-  std::size_t count = 0;
+  if( pool && copied )
+    pool -> run( rulesets.size(), learn );
+  else
+    for( std::size_t k = 0; k < rulesets.size(); ++k )
+      learn( k, 0 );
+
+  CRuleset ruleset;
+  for( const auto & x : rulesets )
+    for( std::size_t i = 0; i < x.size(); ++i )
+      ruleset.add_rule( x[i] );
+  // default rule
+  ruleset.add_rule( CRule( classes.back().second, true ) );
+
+  return ruleset;
+}
+
+std::vector<std::size_t> CRuleLearner::predict_multiclass( const CRuleset & ruleset,
+                                                           const CDataset & X ) const{
+  return predict_multiclass( ruleset, X, m_n_threads );
+}
+
+std::vector<std::size_t> CRuleLearner::predict_multiclass( const CRuleset & ruleset,
+                                                           const CDataset & X,
+                                                           std::size_t n_threads ) const{
+
+  if( ! X.cols() )
+    throw std::invalid_argument( "Empty data!" );
+
+  CCompiledRuleset compiled( ruleset );
+  std::vector<std::size_t> classes;
+  for( std::size_t i = 0; i < compiled.size(); ++i )
+    classes.push_back( compiled.predicted_class( i ) );
+  classes.push_back( 0 );
+
+  return predict_rows( compiled, classes, X, n_threads );
+}
+
+void CRuleLearner::confusion_matrix( const CRuleset & ruleset,
+                                     std::size_t start_index,
+                                     const std::vector<std::vector<double>> & X,
+                                     const std::vector<std::size_t> & pos,
+                                     const std::vector<std::size_t> & neg, 
+                                     std::size_t & tn, std::size_t & fp,
+                                     std::size_t & fn, std::size_t & tp ){
+  confusion_matrix( ruleset, start_index, CDataset( X ), pos, neg,
+                    tn, fp, fn, tp );
+}
+
+CRule CRuleLearner::grow_rule( const std::vector<std::vector<double>> & X,
+                               const std::vector<std::string> & feature_names,
+                               const std::vector<std::size_t> & pos_grow,
+                               const std::vector<std::size_t> & neg_grow ){
+  return grow_rule( CDataset( X ), feature_names, pos_grow, neg_grow );
+}
+
+CRule CRuleLearner::grow_rule( const std::vector<std::vector<double>> & X,
+                               const std::vector<std::string> & feature_names,
+                               const std::vector<std::size_t> & pos_grow,
+                               const std::vector<std::size_t> & neg_grow,
+                               const CRule & r ){
+  return grow_rule( CDataset( X ), feature_names, pos_grow, neg_grow, r );
+}
+
+CCondition * CRuleLearner::find_literal( const std::vector<std::vector<double>> & X,
+                                         const std::vector<std::string> & feature_names,
+                                         const std::vector<std::size_t> & pos_grow,
+                                         const std::vector<std::size_t> & neg_grow,
+                                         std::size_t pos_size, std::size_t neg_size ){
+  return find_literal( CDataset( X ), feature_names, pos_grow, neg_grow,
+                       pos_size, neg_size );
+}
+
+CRule CRuleLearner::prune_rule( const CRule & old_rule,
+                                const std::vector<std::vector<double>> & X,
+                                const std::vector<std::size_t> & pos_prune,
+                                const std::vector<std::size_t> & neg_prune ){
+  return prune_rule( old_rule, CDataset( X ), pos_prune, neg_prune );
+}
+
+double CRuleLearner::rule_error( const std::vector<std::vector<double>> & X,
+                                 const CRule & rule,
+                                 const std::vector<std::size_t> & pos_prune,
+                                 const std::vector<std::size_t> & neg_prune ) const{
+  return rule_error( CDataset( X ), rule, pos_prune, neg_prune );
+}
+
+std::vector<std::size_t> CRuleLearner::predict(
+                        const CRuleset & ruleset,
+                        const std::vector<std::vector<double>> & X,
+                        std::size_t positive_class ) const{
+  return predict( ruleset, CDataset( X ), positive_class );
+}
+
+double CRuleLearner::total_description_length( const CRuleset & ruleset,
+                                               const std::vector<std::vector<double>> & X,
+                                               const std::vector<std::size_t> & y_true,
+                                               std::size_t positive_class ) const{
+  return total_description_length( ruleset, CDataset( X ), y_true, positive_class );
+}
+
+double CRuleLearner::total_description_length( const CRuleset & ruleset,
+                                               const std::vector<std::vector<double>> & X,
+                                               const std::vector<std::size_t> & y_true,
+                                               std::size_t positive_class,
+                                               std::size_t conditions_count ) const{
+  return total_description_length( ruleset, CDataset( X ), y_true, positive_class,
+                                   conditions_count );
+}
 
-  for( const auto & row : X )
-    count += unique( row ).size();
+double CRuleLearner::exception_bits( const CRuleset & ruleset,
+                                     const std::vector<std::vector<double>> & X,
+                                     const std::vector<std::size_t> & y_true,
+                                     std::size_t positive_class ) const{
+  return exception_bits( ruleset, CDataset( X ), y_true, positive_class );
+}
 
-  return count; 
+CRuleset CRuleLearner::fit_multiclass( const std::vector<std::vector<double>> & X,
+                                       const std::vector<std::size_t> & Y,
+                                       const std::vector<std::string> & feature_names ){
+  CDataset data( X );
+  data.encode_categories( m_categorical_max );
+  return fit_multiclass( data, Y, feature_names );
+}
+
+std::vector<std::size_t> CRuleLearner::predict_multiclass(
+                        const CRuleset & ruleset,
+                        const std::vector<std::vector<double>> & X ) const{
+  return predict_multiclass( ruleset, CDataset( X ) );
+}
+
+std::size_t CRuleLearner::unique_conditions( const std::vector<std::vector<double>> & X ) const{
+  return unique_conditions( CDataset( X ) );
 }
 
 CIREP::CIREP( void ):
@@ -484,25 +1205,32 @@ CIREP::CIREP( double split_ratio, std::size_t random_state,
                   64, prune_rules, n_threads, pruning_metric ){
 }
 
-CRuleset CIREP::fit( const std::vector<std::vector<double>> & X,
+CRuleLearner * CIREP::clone( void ) const{
+  return new CIREP( *this );
+}
+
+CRuleset CIREP::fit( const CDataset & X,
                      const std::vector<std::size_t> & Y,
                      const std::vector<std::string> & feature_names,
                      std::size_t positive_class ){
 
-  if( ! X.size() || ! Y.size() )
+  if( ! X.cols() || ! Y.size() )
     throw std::invalid_argument( "Input vectors are empty!" );
-  else if( X.front().size() != Y.size() )
+  else if( X.rows() != Y.size() )
     throw std::invalid_argument( "X and Y sizes differ!" );
-  else if( X.size() != feature_names.size() )
+  else if( X.cols() != feature_names.size() )
     throw std::invalid_argument( "Y and feature names differ!" );
 
   std::vector<std::size_t> pos;
   std::vector<std::size_t> neg;
   pos_neg_split( Y, positive_class, pos, neg );
 
+  CFitScope scope( *this, X );
   CRuleset ruleset;
   std::vector<std::size_t> pos_grow,pos_prune;
   std::vector<std::size_t> neg_grow,neg_prune;
+  CCoverage pos_mask( X.rows(), pos );
+  CCoverage neg_mask( X.rows(), neg );
 
   while( ! pos.empty() ){    
 
@@ -539,8 +1267,10 @@ CRuleset CIREP::fit( const std::vector<std::vector<double>> & X,
       break;
     }
 
-    pos = rule.not_covered_indices( X, pos );
-    neg = rule.not_covered_indices( X, neg );
+    pos_mask.and_not( rule.covered_mask( X, pos_mask ) );
+    neg_mask.and_not( rule.covered_mask( X, neg_mask ) );
+    pos = pos_mask.to_indices();
+    neg = neg_mask.to_indices();
     // add to ruleset
     ruleset.add_rule( rule );
 
@@ -561,7 +1291,15 @@ CRIPPER::CRIPPER( double split_ratio, std::size_t random_state,
                   difference, prune_rules, n_threads, pruning_metric ), m_k( k ){
 }
 
-CRuleset CRIPPER::IREP_star( const std::vector<std::vector<double>> & X,
+CRuleLearner * CRIPPER::clone( void ) const{
+  return new CRIPPER( *this );
+}
+
+bool CRIPPER::uses_description_length( void ) const{
+  return true;
+}
+
+CRuleset CRIPPER::IREP_star( const CDataset & X,
                              const std::vector<std::size_t> & Y,
                              const std::vector<std::size_t> pos,
                              const std::vector<std::size_t> neg,
@@ -579,12 +1317,14 @@ CRuleset CRIPPER::IREP_star( const std::vector<std::vector<double>> & X,
   CRuleset ruleset( input_ruleset );
   auto pos_copy = pos;
   auto neg_copy = neg;
+  CCoverage pos_mask( X.rows(), pos );
+  CCoverage neg_mask( X.rows(), neg );
   std::vector<std::size_t> pos_grow, pos_prune;
   std::vector<std::size_t> neg_grow, neg_prune;
 
-  std::size_t tn, fp, fn, tp;
-  tn = fp = fn = tp = 0;
-  confusion_matrix( ruleset, 0, X, pos, neg, tn, fp, fn, tp );
+  CConfusion confusion;
+  confusion_matrix( ruleset, 0, X, pos, neg, confusion.tn, confusion.fp,
+                    confusion.fn, confusion.tp );
 
   // minimum description length
   double MDL = std::numeric_limits<double>::max();
@@ -593,7 +1333,7 @@ CRuleset CRIPPER::IREP_star( const std::vector<std::vector<double>> & X,
   // rule description length
   double RDL = total_description_length( ruleset, X, Y, positive_class,
                                          conditions_count );
-  double exceptions = exception_bits( tn, fp, fn, tp );
+  double exceptions = exception_bits( confusion );
   RDL -= exceptions;
 
   while( ! pos_copy.empty() ){
@@ -624,19 +1364,15 @@ CRuleset CRIPPER::IREP_star( const std::vector<std::vector<double>> & X,
 
     RDL += rule_bits( rule, conditions_count );
 
-    std::size_t tp_diff = pos_copy.size();
-    std::size_t fp_diff = neg_copy.size();
-    pos_copy = rule.not_covered_indices( X, pos_copy );
-    neg_copy = rule.not_covered_indices( X, neg_copy );
-    
-    tp_diff -= pos_copy.size();
-    fp_diff -= neg_copy.size();
-    tp += tp_diff;
-    fp += fp_diff;
-    fn -= tp_diff; // = pos_copy.size() should be equal
-    tn -= fp_diff; // = neg_copy.size() should be equal
-
-    double exceptions = exception_bits( tn, fp, fn, tp );
+    auto pos_covered = rule.covered_mask( X, pos_mask );
+    auto neg_covered = rule.covered_mask( X, neg_mask );
+    confusion.cover( pos_covered.count(), neg_covered.count() );
+    pos_mask.and_not( pos_covered );
+    neg_mask.and_not( neg_covered );
+    pos_copy = pos_mask.to_indices();
+    neg_copy = neg_mask.to_indices();
+
+    double exceptions = exception_bits( confusion );
     double description_length = RDL + exceptions;
 
     #ifdef __verbose__
@@ -661,18 +1397,19 @@ CRuleset CRIPPER::IREP_star( const std::vector<std::vector<double>> & X,
   return ruleset;
 }
 
-CRuleset CRIPPER::fit( const std::vector<std::vector<double>> & X,
+CRuleset CRIPPER::fit( const CDataset & X,
                        const std::vector<std::size_t> & Y,
                        const std::vector<std::string> & feature_names,
                        std::size_t positive_class ){ 
 
-  if( ! X.size() || ! Y.size() )
+  if( ! X.cols() || ! Y.size() )
     throw std::invalid_argument( "Input vectors are empty!" );
-  else if( X.front().size() != Y.size() )
+  else if( X.rows() != Y.size() )
     throw std::invalid_argument( "X and Y sizes differ!" );
-  else if( X.size() != feature_names.size() )
+  else if( X.cols() != feature_names.size() )
     throw std::invalid_argument( "Y and feature names differ!" );
 
+  CFitScope scope( *this, X );
   CRuleset ruleset;
   std::vector<std::size_t> pos;
   std::vector<std::size_t> neg;
@@ -687,8 +1424,10 @@ CRuleset CRIPPER::fit( const std::vector<std::vector<double>> & X,
     // optimise_ruleset
     ruleset = optimise_ruleset( ruleset, X, Y, feature_names, pos, neg,
                                 positive_class );
-    auto pos_remaining = ruleset.not_covered_indices( X, pos );
-    auto neg_remaining = ruleset.not_covered_indices( X, neg );
+    auto pos_remaining =
+      ruleset.not_covered_mask( X, CCoverage( X.rows(), pos ) ).to_indices();
+    auto neg_remaining =
+      ruleset.not_covered_mask( X, CCoverage( X.rows(), neg ) ).to_indices();
     // cover remaining samples
     ruleset = IREP_star( X, Y, pos_remaining, neg_remaining,
                          feature_names, positive_class, ruleset );
@@ -699,7 +1438,7 @@ CRuleset CRIPPER::fit( const std::vector<std::vector<double>> & X,
 }
 
 CRuleset CRIPPER::optimise_ruleset( const CRuleset & input_ruleset,
-                                    const std::vector<std::vector<double>> & X,
+                                    const CDataset & X,
                                     const std::vector<std::size_t> & Y,
                                     const std::vector<std::string> & feature_names,
                                     const std::vector<std::size_t> & pos,
@@ -713,16 +1452,11 @@ CRuleset CRIPPER::optimise_ruleset( const CRuleset & input_ruleset,
   CRuleset ruleset( input_ruleset );
   std::size_t conditions_count = unique_conditions( X );
 
-  // TODO new part
-  std::size_t tn, fp, fn, tp; 
-  confusion_matrix( ruleset, 0, X, pos, neg, tn, fp, fn, tp );
-
-  double RDL = 0;
-  for( std::size_t i = 0; i < ruleset.size(); ++i )
-    RDL += rule_bits( ruleset[i], conditions_count );
-
-  double exceptions = exception_bits( tn, fp, fn, tp );
-  // TODO
+  // masks of the rules over all rows, the description lengths of the
+  // candidate rulesets are counted from them
+  CRulesetCoverage coverage( ruleset, X, Y, positive_class );
+  // created here, the split search below only reads it
+  CThreadPool * pool = thread_pool();
 
   for( std::size_t i = 0; i < input_ruleset.size(); ++i ){
 
@@ -732,36 +1466,61 @@ CRuleset CRIPPER::optimise_ruleset( const CRuleset & input_ruleset,
     data_split( pos_copy, pos_grow, pos_prune );
     data_split( neg_copy, neg_grow, neg_prune );
 
-    // replacement
-    CRule replacement = grow_rule( X, feature_names, pos_grow, neg_grow );
     CRuleset replacement_ruleset( ruleset );
-    replacement_ruleset[i] = replacement;
-    replacement_ruleset[i] = optimise_prune( replacement_ruleset, i, X,
-                                             pos_prune, neg_prune );
-    double replacement_TDL = total_description_length( replacement_ruleset, X, Y,
-                                                       positive_class, conditions_count );
+    CRuleset revision_ruleset( ruleset );
+    double replacement_TDL, revision_TDL, original_TDL;
+
+    // the replacement, the revision and the original ruleset are
+    // scored independently, each task writes only its own results
+    // - they run as tasks only while the split search is too small to
+    //   scan the features in parallel, a task runs its searches serially
+    auto score = [&]( std::size_t task, std::size_t ){
+      std::size_t tn, fp, fn, tp;
+      if( task == 0 ){
+        // replacement
+        replacement_ruleset[i] = grow_rule( X, feature_names, pos_grow, neg_grow );
+        replacement_ruleset[i] = optimise_prune( replacement_ruleset, i, X,
+                                                 pos_prune, neg_prune );
+        CCoverage mask = coverage.rule_mask( replacement_ruleset[i] );
+        coverage.confusion_matrix_with( i, mask, tn, fp, fn, tp );
+        replacement_TDL = total_description_length( replacement_ruleset,
+                                                    conditions_count, tn, fp, fn, tp );
+      }
+      else if( task == 1 ){
+        // revision
+        revision_ruleset[i] = grow_rule( X, feature_names, pos_grow, neg_grow,
+                                         ruleset[i] );
+        revision_ruleset[i] = optimise_prune( revision_ruleset, i, X,
+                                              pos_prune, neg_prune );
+        CCoverage mask = coverage.rule_mask( revision_ruleset[i] );
+        coverage.confusion_matrix_with( i, mask, tn, fp, fn, tp );
+        revision_TDL = total_description_length( revision_ruleset,
+                                                 conditions_count, tn, fp, fn, tp );
+      }
+      else{
+        coverage.confusion_matrix( tn, fp, fn, tp );
+        original_TDL = total_description_length( ruleset, conditions_count,
+                                                 tn, fp, fn, tp );
+      }
+    };
+
+    std::size_t active = pos_grow.size() + neg_grow.size();
+    if( pool && ! parallel_split( active, feature_names.size() ) )
+      pool -> run( 3, score );
+    else
+      for( std::size_t task = 0; task < 3; ++task )
+        score( task, 0 );
+
     if( replacement_TDL < best_score ){
       best_score = replacement_TDL;
       best_ruleset = replacement_ruleset;
     }
 
-    // revision
-    CRule revision = ruleset[i];
-    revision = grow_rule( X, feature_names, pos_grow, neg_grow, revision );
-    CRuleset revision_ruleset( ruleset );
-    revision_ruleset[i] = revision;
-    revision_ruleset[i] = optimise_prune( revision_ruleset, i, X,
-                                          pos_prune, neg_prune );
-    double revision_TDL = total_description_length( revision_ruleset, X, Y,
-                                                    positive_class, conditions_count );
-    
     if( revision_TDL < best_score ){
       best_score = revision_TDL;
       best_ruleset = revision_ruleset;
     }
 
-    double original_TDL = total_description_length( ruleset, X, Y, positive_class,
-                                                    conditions_count );
     #ifdef __verbose__
       __logger.log( "-- TDL Scores ... Replacement: " + std::to_string( replacement_TDL ) +
                     ", Revision: " + std::to_string( revision_TDL ) +
@@ -773,10 +1532,11 @@ CRuleset CRIPPER::optimise_ruleset( const CRuleset & input_ruleset,
         __logger.log( "-- Changing rule in ruleset!" );
       #endif
       ruleset = best_ruleset;
+      coverage.replace( i, ruleset[i] );
     }
 
-    pos_copy = ruleset[i].not_covered_indices( X, pos_copy );
-    neg_copy = ruleset[i].not_covered_indices( X, neg_copy );
+    ruleset[i].not_covered_indices( X, pos_copy, pos_copy );
+    ruleset[i].not_covered_indices( X, neg_copy, neg_copy );
 
   } 
 
@@ -785,7 +1545,7 @@ CRuleset CRIPPER::optimise_ruleset( const CRuleset & input_ruleset,
 
 CRule CRIPPER::optimise_prune( const CRuleset & input_ruleset,
                                std::size_t index,
-                               const std::vector<std::vector<double>> & X,
+                               const CDataset & X,
                                const std::vector<std::size_t> & pos_prune,
                                const std::vector<std::size_t> & neg_prune ){
   std::size_t tn, fp, fn, tp;
@@ -821,29 +1581,72 @@ CRule CRIPPER::optimise_prune( const CRuleset & input_ruleset,
 }
 
 CRuleset CRIPPER::generalise_ruleset( const CRuleset & input_ruleset,
-                                      const std::vector<std::vector<double>> & X,
+                                      const CDataset & X,
                                       const std::vector<std::size_t> & Y,
                                       std::size_t positive_class ) const{
   std::size_t conditions_count = unique_conditions( X );
   CRuleset best_ruleset( input_ruleset );
-  double best_TDL = total_description_length( best_ruleset, X, Y, positive_class,
-                                              conditions_count );
+  // removing a rule only drops its mask from the union
+  CRulesetCoverage coverage( best_ruleset, X, Y, positive_class );
+  std::size_t tn, fp, fn, tp;
+  coverage.confusion_matrix( tn, fp, fn, tp );
+  double best_TDL = total_description_length( best_ruleset, conditions_count,
+                                              tn, fp, fn, tp );
   for( std::size_t i = input_ruleset.size() - 1; i < input_ruleset.size(); --i ){
     CRuleset new_ruleset( best_ruleset );
     new_ruleset.pop( i );
-    double new_TDL = total_description_length( new_ruleset, X, Y, positive_class,
-                                               conditions_count );
+    coverage.confusion_matrix_without( i, tn, fp, fn, tp );
+    double new_TDL = total_description_length( new_ruleset, conditions_count,
+                                               tn, fp, fn, tp );
     if( new_TDL < best_TDL ){
       #ifdef __verbose__
         __logger.log( "-- Generalise: removed rule with index #" + std::to_string( i ) );
       #endif
       best_ruleset = new_ruleset;
       best_TDL = new_TDL;
+      coverage.erase( i );
     }
   }
   return best_ruleset;
 }
 
+CRuleset CRIPPER::IREP_star( const std::vector<std::vector<double>> & X,
+                             const std::vector<std::size_t> & Y,
+                             const std::vector<std::size_t> pos,
+                             const std::vector<std::size_t> neg,
+                             const std::vector<std::string> & feature_names,
+                             std::size_t positive_class,
+                             const CRuleset & input_ruleset ){
+  return IREP_star( CDataset( X ), Y, pos, neg, feature_names, positive_class,
+                    input_ruleset );
+}
+
+CRuleset CRIPPER::optimise_ruleset( const CRuleset & input_ruleset,
+                                    const std::vector<std::vector<double>> & X,
+                                    const std::vector<std::size_t> & Y,
+                                    const std::vector<std::string> & feature_names,
+                                    const std::vector<std::size_t> & pos,
+                                    const std::vector<std::size_t> & neg,
+                                    std::size_t positive_class ){
+  return optimise_ruleset( input_ruleset, CDataset( X ), Y, feature_names,
+                           pos, neg, positive_class );
+}
+
+CRule CRIPPER::optimise_prune( const CRuleset & input_ruleset,
+                               std::size_t index,
+                               const std::vector<std::vector<double>> & X,
+                               const std::vector<std::size_t> & pos_prune,
+                               const std::vector<std::size_t> & neg_prune ){
+  return optimise_prune( input_ruleset, index, CDataset( X ), pos_prune, neg_prune );
+}
+
+CRuleset CRIPPER::generalise_ruleset( const CRuleset & input_ruleset,
+                                      const std::vector<std::vector<double>> & X,
+                                      const std::vector<std::size_t> & Y,
+                                      std::size_t positive_class ) const{
+  return generalise_ruleset( input_ruleset, CDataset( X ), Y, positive_class );
+}
+
 CCompetitor::CCompetitor( void ):
     CRuleLearner(){
 }
@@ -856,18 +1659,29 @@ CCompetitor::CCompetitor( double split_ratio, std::size_t random_state,
                   prune_rules, n_threads, pruning_metric ){
 }
 
-CRuleset CCompetitor::fit( const std::vector<std::vector<double>> & X,
+CRuleLearner * CCompetitor::clone( void ) const{
+  return new CCompetitor( *this );
+}
+
+bool CCompetitor::uses_description_length( void ) const{
+  return true;
+}
+
+CRuleset CCompetitor::fit( const CDataset & X,
                            const std::vector<std::size_t> & Y,
                            const std::vector<std::string> & feature_names,
                            std::size_t positive_class ){ 
 
 
+  CFitScope scope( *this, X );
   CRuleset ruleset;
   std::vector<std::size_t> pos,neg;
   std::vector<std::size_t> pos_grow, pos_prune;
   std::vector<std::size_t> neg_grow, neg_prune;
 
   pos_neg_split( Y, positive_class, pos, neg ); 
+  CCoverage pos_mask( X.rows(), pos );
+  CCoverage neg_mask( X.rows(), neg );
 
   // minimum description length
   double MDL = std::numeric_limits<double>::max();
@@ -875,6 +1689,10 @@ CRuleset CCompetitor::fit( const std::vector<std::vector<double>> & X,
   std::size_t conditions_count = unique_conditions( X );
   // rule description length
   double RDL = 0;
+  // confusion matrix of the rules added so far
+  CConfusion confusion( pos.size(), neg.size() );
+  // created here, the split search below only reads it
+  CThreadPool * pool = thread_pool();
 
   while( ! pos.empty() ){
 
@@ -886,50 +1704,56 @@ CRuleset CCompetitor::fit( const std::vector<std::vector<double>> & X,
     data_split( pos, pos_grow, pos_prune );
     data_split( neg, neg_grow, neg_prune );
 
-    // grow a rule
+    // grow a rule on either half of the data and prune it on the
+    // other one, the two pipelines share no state
     #ifdef __verbose__
       __logger.log( "-- Growing" );
     #endif
-    auto rule_grow = grow_rule( X, feature_names, pos_grow, neg_grow );
-    auto rule_prune = grow_rule( X, feature_names, pos_prune, neg_prune );
-    // prune the rule
-    if( m_prune_rules ){
-      #ifdef __verbose__
-      {
-        __logger.log( "-- Pruning rule_grow with size: " + std::to_string( rule_grow.size() ) );
-        __logger.log( "-- Pruning rule_prune with size: " + std::to_string( rule_prune.size() ) );
-
-        double metric_val = m_pruning_metric( X, rule_grow, pos_prune, neg_prune );
-        __logger.log( "-- rule_grow metric val: " + std::to_string( metric_val ) );
-        metric_val = m_pruning_metric( X, rule_prune, pos_grow, neg_grow );
-        __logger.log( "-- rule_prune metric val: " + std::to_string( metric_val ) );
+    CRule rules[2];
+    double values[2];
+    auto compete = [&]( std::size_t task, std::size_t ){
+      const auto & pos_fit = task ? pos_prune : pos_grow;
+      const auto & neg_fit = task ? neg_prune : neg_grow;
+      const auto & pos_eval = task ? pos_grow : pos_prune;
+      const auto & neg_eval = task ? neg_grow : neg_prune;
+      CRule rule = grow_rule( X, feature_names, pos_fit, neg_fit );
+      // prune the rule
+      if( m_prune_rules ){
+        #ifdef __verbose__
+          std::string name = task ? "rule_prune" : "rule_grow";
+          __logger.log( "-- Pruning " + name + " with size: " + std::to_string( rule.size() ) );
+          double metric_val = pruning_metric( X, rule, pos_eval, neg_eval );
+          __logger.log( "-- " + name + " metric val: " + std::to_string( metric_val ) );
+        #endif
+        rule = prune_rule( rule, X, pos_eval, neg_eval );
+        #ifdef __verbose__
+          __logger.log( "-- Pruned " + name + " has size: " + std::to_string( rule.size() ) );
+          metric_val = pruning_metric( X, rule, pos_eval, neg_eval );
+          __logger.log( "-- Pruned " + name + " metric val: " + std::to_string( metric_val ) );
+        #endif
       }
-      #endif
-      rule_grow = prune_rule( rule_grow, X, pos_prune, neg_prune );
-      rule_prune = prune_rule( rule_prune, X, pos_grow, neg_grow );
-      #ifdef __verbose__
-        __logger.log("-- Pruned rule_grow has size: " + std::to_string( rule_grow.size() ) );
-        __logger.log("-- Pruned rule_prune has size: " + std::to_string( rule_prune.size() ) );
-
-        double metric_val = m_pruning_metric( X, rule_grow, pos_prune, neg_prune );
-        __logger.log( "-- Pruned rule_grow metric val: " + std::to_string( metric_val ) );
-        metric_val = m_pruning_metric( X, rule_prune, pos_grow, neg_grow );
-        __logger.log( "-- Pruned rule_prune metric val: " + std::to_string( metric_val ) );
-      #endif
-    }
+      values[task] = pruning_metric( X, rule, pos_eval, neg_eval );
+      rules[task] = rule;
+    };
+
+    // the competitors run as tasks only while their split search is
+    // too small to scan the features in parallel
+    std::size_t active = std::max( pos_grow.size() + neg_grow.size(),
+                                   pos_prune.size() + neg_prune.size() );
+    if( pool && ! parallel_split( active, feature_names.size() ) )
+      pool -> run( 2, compete );
+    else
+      for( std::size_t task = 0; task < 2; ++task )
+        compete( task, 0 );
 
     CRule rule;
-    double grow_val = m_pruning_metric( X, rule_grow, pos_prune, neg_prune );
-    double prune_val = m_pruning_metric( X, rule_prune, pos_grow, neg_grow );
-    if( grow_val > prune_val )
-      rule = rule_grow;
+    if( values[0] > values[1] )
+      rule = rules[0];
     else
-      rule = rule_prune;
+      rule = rules[1];
 
     RDL += rule_bits( rule, conditions_count );
-    CRuleset review_ruleset( ruleset );
-    review_ruleset.add_rule( rule );
-    double exceptions = exception_bits( ruleset, X, Y, positive_class );
+    double exceptions = exception_bits( confusion );
     double description_length = RDL + exceptions;
 
     #ifdef __verbose__
@@ -946,8 +1770,13 @@ CRuleset CCompetitor::fit( const std::vector<std::vector<double>> & X,
     else if( description_length < MDL )
       MDL = description_length;
 
-    pos = rule.not_covered_indices( X, pos );
-    neg = rule.not_covered_indices( X, neg );
+    auto pos_covered = rule.covered_mask( X, pos_mask );
+    auto neg_covered = rule.covered_mask( X, neg_mask );
+    confusion.cover( pos_covered.count(), neg_covered.count() );
+    pos_mask.and_not( pos_covered );
+    neg_mask.and_not( neg_covered );
+    pos = pos_mask.to_indices();
+    neg = neg_mask.to_indices();
     // add to ruleset
     ruleset.add_rule( rule );
 
@@ -958,18 +1787,28 @@ CRuleset CCompetitor::fit( const std::vector<std::vector<double>> & X,
 COneR::COneR( void ){
 }
 
-CRuleset COneR::fit( const std::vector<std::vector<double>> & X,
+COneR::COneR( std::size_t n_threads ){
+  m_n_threads = n_threads;
+}
+
+CRuleLearner * COneR::clone( void ) const{
+  return new COneR( *this );
+}
+
+CRuleset COneR::fit( const CDataset & X,
                      const std::vector<std::size_t> & Y,
                      const std::vector<std::string> & feature_names,
                      std::size_t positive_class ){
 
+  CFitScope scope( *this, X );
   CRuleset best_ruleset;
   double best_acc = std::numeric_limits<double>::lowest();
 
-  for( std::size_t i = 0; i < X.size(); ++i ){
+  for( std::size_t i = 0; i < X.cols(); ++i ){
 
     CRuleset ruleset;
-    if( m_categorical_max && unique( X[i] ).size() <= m_categorical_max ){
+    if( m_categorical_max &&
+        unique( X.column( i ), X.rows() ).size() <= m_categorical_max ){
       /* TODO */
     }
     else{ 
@@ -996,54 +1835,84 @@ CRuleset COneR::fit( const std::vector<std::vector<double>> & X,
 }
 
 std::vector<std::size_t> COneR::predict( const CRuleset & ruleset,
-                                         const std::vector<std::vector<double>> & X,
+                                         const CDataset & X,
                                          std::size_t positive_class ) const{
-  // suppress warning about unused parameter
-  (void)positive_class;
-  return predict( ruleset, X );
+  return predict( ruleset, X, positive_class, m_n_threads );
 }
 
 std::vector<std::size_t> COneR::predict( const CRuleset & ruleset,
-                                         const std::vector<std::vector<double>> & X ) const{
+                                         const CDataset & X ) const{
+  return predict( ruleset, X, 0, m_n_threads );
+}
 
-  if( ! X.size() )
+std::vector<std::size_t> COneR::predict( const CRuleset & ruleset,
+                                         const CDataset & X,
+                                         std::size_t positive_class,
+                                         std::size_t n_threads ) const{
+  // suppress warning about unused parameter
+  (void)positive_class;
+
+  if( ! X.cols() )
     throw std::invalid_argument( "Input vector is empty!" );
   else if( ! ruleset.size() )
     throw std::invalid_argument( "Input ruleset is empty!" );
 
-  std::vector<std::size_t> predictions( X[0].size() );
-  std::vector<std::size_t> indices( X[0].size() );
-  std::iota( std::begin( indices ), std::end( indices ), 0 ); 
+  // rulesets of discretise are a table of intervals on one feature
+  if( ! CIntervalTable::fits( ruleset ) )
+    return predict_multiclass( ruleset, X, n_threads );
 
-  for( std::size_t i = 0; i < ruleset.size(); ++i ){
-    const auto & rule = ruleset[i];
-    auto predicted_class = rule.predicted_class();
-    auto covered = rule.covered_indices( X, indices );
-    indices = rule.not_covered_indices( X, indices );
+  CIntervalTable table( ruleset );
+  if( table.feature() >= X.cols() )
+    throw std::invalid_argument( "Ruleset uses more features than the data has!" );
 
-    for( auto & i : covered )
-      predictions[i] = predicted_class;
-  }
+  // every worker looks up its own slice of the rows
+  std::vector<std::size_t> predicted( X.rows() );
+  const double * column = X.column( table.feature() );
+  for_row_chunks( X.rows(), n_threads, [&]( std::size_t first, std::size_t last ){
+    table.predict( column + first, last - first, predicted.data() + first );
+  } );
 
-  return predictions;
+  return predicted;
+}
+
+std::vector<std::size_t> COneR::predict( const CRuleset & ruleset,
+                                         const std::vector<std::vector<double>> & X ) const{
+  return predict( ruleset, CDataset( X ) );
 }
 
 CRuleset COneR::discretise( std::size_t row,
-                            const std::vector<std::vector<double>> & X,
+                            const CDataset & X,
                             const std::vector<std::size_t> & Y,
                             const std::vector<std::string> & feature_names,
                             std::size_t positive_class,
                             std::size_t min_class ) const{
 
-  if( ! X.size() || ! Y.size()  )
+  if( ! X.cols() || ! Y.size()  )
     throw std::invalid_argument( "Input vector is empty!" );
 
-  const std::vector<double> & X_row = X[row];
+  const double * X_row = X.column( row );
 
-  if( X_row.size() != Y.size() )
+  if( X.rows() != Y.size() )
     throw std::invalid_argument( "X and Y sizes differ!" ); 
 
-  std::vector<std::size_t> indices = sort_by_indices( X_row ); 
+  // NaN rows are set apart, no interval covers them
+  std::vector<std::size_t> indices;
+  if( m_sorted -> built_for( X ) ){
+    const std::uint32_t * order = m_sorted -> column( row );
+    for( std::size_t i = 0; i < X.rows() && ! std::isnan( X_row[ order[i] ] ); ++i )
+      indices.push_back( order[i] );
+  }
+  else{
+    for( std::size_t i = 0; i < X.rows(); ++i )
+      if( ! std::isnan( X_row[i] ) )
+        indices.push_back( i );
+    std::sort( indices.begin(), indices.end(),
+      [&]( std::size_t a, std::size_t b ){ return X_row[a] < X_row[b]; }
+    );
+  }
+
+  if( indices.empty() )
+    return CRuleset();
 
   CRuleset ruleset;
   // a - positive class, b - other class
@@ -11,7 +11,13 @@
 #include <cmath>
 #include <iterator>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include "./dataset.hpp"
+#include "./thread_pool.hpp"
 #include "./ruleset.hpp"
+#include "./compiled_ruleset.hpp"
+#include "./interval_table.hpp"
 #include "./utils.hpp"
 
 #ifdef __verbose__
@@ -19,6 +25,131 @@
   extern CLogger __logger;
 #endif
 
+/**
+ * (C)SplitCandidate is the best condition found by the split search
+ * so far. It is plain data, so an improvement of the gain costs no
+ * allocation, the CCondition is built once the search is over.
+ */
+struct CSplitCandidate{
+  double gain;
+  std::size_t index; // feature index
+  CCondition::EOperator op;
+  double value;
+  bool found;
+
+  CSplitCandidate( void ):
+      gain( std::numeric_limits<double>::lowest() ), index( 0 ),
+      op( CCondition::EOperator::LE ), value( 0 ), found( false ){}
+  /**
+   * @in: gain, feature index, operator, value
+   * - take over the given condition if its gain is strictly higher
+   */
+  void offer( double x_gain, std::size_t x_index,
+              CCondition::EOperator x_op, double x_value ){
+    if( x_gain > gain ){
+      gain = x_gain;
+      index = x_index;
+      op = x_op;
+      value = x_value;
+      found = true;
+    }
+  }
+  /**
+   * @in: candidate
+   * @out: true if the candidate is better, ties go to the lower
+   *       feature index (the result of a sequential scan)
+   */
+  bool worse_than( const CSplitCandidate & x ) const{
+    if( ! x.found )
+      return false;
+    return ! found || x.gain > gain || ( x.gain == gain && x.index < index );
+  }
+};
+
+/**
+ * (C)Confusion accumulates the confusion matrix of a ruleset that
+ * is learned rule by rule, every added rule moves the samples it
+ * newly covers from fn to tp and from tn to fp.
+ */
+struct CConfusion{
+  std::size_t tn, fp, fn, tp;
+
+  CConfusion( void ): tn( 0 ), fp( 0 ), fn( 0 ), tp( 0 ){}
+  /**
+   * @in: number of positive and negative samples
+   * - matrix of the empty ruleset
+   */
+  CConfusion( std::size_t pos, std::size_t neg ):
+      tn( neg ), fp( 0 ), fn( pos ), tp( 0 ){}
+  /**
+   * @in: number of positive and negative samples covered by
+   *      a new rule and none of the previous ones
+   */
+  void cover( std::size_t pos, std::size_t neg ){
+    tp += pos;
+    fn -= pos;
+    fp += neg;
+    tn -= neg;
+  }
+};
+
+/**
+ * (C)RulesetCoverage caches the coverage mask of every rule of
+ * a ruleset over the whole dataset, so that the confusion matrix
+ * of the ruleset with a rule removed or replaced is a union of the
+ * cached masks and a few popcounts, no row is predicted again.
+ * - all rules are taken to predict the positive class, as in
+ *   CRuleLearner::predict
+ */
+class CRulesetCoverage{
+
+  public:
+    /**
+     * @in: ruleset, dataset, true classes, positive class
+     * - the dataset must outlive the cache
+     */
+    CRulesetCoverage( const CRuleset & ruleset, const CDataset & X,
+                      const std::vector<std::size_t> & y_true,
+                      std::size_t positive_class );
+    /** return number of cached rules */
+    std::size_t size( void ) const;
+    /** return coverage of a rule over the whole dataset */
+    CCoverage rule_mask( const CRule & rule ) const;
+    /** replace the cached rule at idx */
+    void replace( std::size_t idx, const CRule & rule );
+    /** remove the cached rule at idx */
+    void erase( std::size_t idx );
+    /** confusion matrix of the cached ruleset */
+    void confusion_matrix( std::size_t & tn, std::size_t & fp,
+                           std::size_t & fn, std::size_t & tp ) const;
+    /** confusion matrix of the cached ruleset without the rule at idx */
+    void confusion_matrix_without( std::size_t idx,
+                                   std::size_t & tn, std::size_t & fp,
+                                   std::size_t & fn, std::size_t & tp ) const;
+    /**
+     * @in: index, coverage of a rule ( see rule_mask )
+     * - confusion matrix of the cached ruleset with the rule at idx
+     *   replaced by the given one
+     */
+    void confusion_matrix_with( std::size_t idx, const CCoverage & mask,
+                                std::size_t & tn, std::size_t & fp,
+                                std::size_t & fn, std::size_t & tp ) const;
+
+  private:
+    const CDataset & m_data;
+    bool m_predicts; // false if the positive class is 0
+    CCoverage m_labels; // rows with a non-zero class
+    std::vector<CCoverage> m_masks;
+
+    /**
+     * @in: index of the rule to skip or replace ( or npos ),
+     *      its replacement ( or nullptr )
+     */
+    void count( std::size_t idx, const CCoverage * mask,
+                std::size_t & tn, std::size_t & fp,
+                std::size_t & fn, std::size_t & tp ) const;
+};
+
 class CRuleLearner{
 
   public:
@@ -27,13 +158,25 @@ class CRuleLearner{
                   std::size_t categorical_max, std::size_t difference,
                   bool prune_rules, std::size_t n_threads,
                   const std::string & pruning_metric );
+    virtual ~CRuleLearner( void ){}
+    /**
+     * @out: copy of the learner owned by the caller, nullptr if
+     *       the learner cannot be copied
+     * - the copy shares the thread pool and the per-fit structures
+     */
+    virtual CRuleLearner * clone( void ) const;
+    /**
+     * @out: true if fit scores rulesets by their description length,
+     *       the unique values of the columns are then counted for the fit
+     */
+    virtual bool uses_description_length( void ) const;
     static void confusion_matrix( const std::vector<std::size_t> & y_true,
                                   const std::vector<std::size_t> & y_pred,
                                   std::size_t & tn, std::size_t & fp,
                                   std::size_t & fn, std::size_t & tp );
     static void confusion_matrix( const CRuleset & ruleset,
                                   std::size_t start_index,
-                                  const std::vector<std::vector<double>> & X,
+                                  const CDataset & X,
                                   const std::vector<std::size_t> & pos,
                                   const std::vector<std::size_t> & neg, 
                                   std::size_t & tn, std::size_t & fp,
@@ -42,10 +185,40 @@ class CRuleLearner{
                                     const std::vector<std::size_t> & y_pred );
     static double measure_accuracy( std::size_t tn, std::size_t fp,
                                     std::size_t fn, std::size_t tp );
-    virtual CRuleset fit( const std::vector<std::vector<double>> & X,
+    virtual CRuleset fit( const CDataset & X,
                           const std::vector<std::size_t> & Y,
                           const std::vector<std::string> & feature_names,
                           std::size_t positive_class ) = 0;
+    CRuleset fit( const std::vector<std::vector<double>> & X,
+                  const std::vector<std::size_t> & Y,
+                  const std::vector<std::string> & feature_names,
+                  std::size_t positive_class );
+    /**
+     * @in: dataset, classes, feature names
+     * @out: decision list over all classes
+     * - one-vs-rest, a binary ruleset is learned by fit for every
+     *   class but the most frequent one, the class against all
+     *   the others
+     * - the per-class learners are copies of this one (see clone),
+     *   they run in parallel on the thread pool and share the
+     *   structures built for X once
+     * - rules are ordered by class frequency, rarest class first,
+     *   and the list ends with an empty rule predicting the most
+     *   frequent class
+     */
+    CRuleset fit_multiclass( const CDataset & X,
+                             const std::vector<std::size_t> & Y,
+                             const std::vector<std::string> & feature_names );
+    /**
+     * @in: decision list, dataset
+     * @out: class of the first rule covering each row, 0 if none
+     */
+    std::vector<std::size_t> predict_multiclass( const CRuleset & ruleset,
+                                                 const CDataset & X ) const;
+    /** same as above on n_threads threads, 0 uses all hardware threads */
+    std::vector<std::size_t> predict_multiclass( const CRuleset & ruleset,
+                                                 const CDataset & X,
+                                                 std::size_t n_threads ) const;
     // division between positive and negative indices
     void pos_neg_split( const std::vector<std::size_t> & Y,
                         std::size_t positive_class,
@@ -56,11 +229,104 @@ class CRuleLearner{
                      std::vector<std::size_t> & a,
                      std::vector<std::size_t> & b );
     // grow rule
-    CRule grow_rule( const std::vector<std::vector<double>> & X,
+    CRule grow_rule( const CDataset & X,
                      const std::vector<std::string> & feature_names,
                      const std::vector<std::size_t> & pos_grow,
                      const std::vector<std::size_t> & neg_grow );
 
+    CRule grow_rule( const CDataset & X,
+                     const std::vector<std::string> & feature_names,
+                     const std::vector<std::size_t> & pos_grow,
+                     const std::vector<std::size_t> & neg_grow,
+                     const CRule & r );
+    // returns a new condition owned by the caller, nullptr if none
+    CCondition * find_literal( const CDataset & X,
+                               const std::vector<std::string> & feature_names,
+                               const std::vector<std::size_t> & pos_grow,
+                               const std::vector<std::size_t> & neg_grow,
+                               std::size_t pos_size, std::size_t neg_size );
+    // same as above, the best split is returned as a candidate
+    CSplitCandidate find_split( const CDataset & X,
+                                std::size_t features,
+                                const std::vector<std::size_t> & pos_grow,
+                                const std::vector<std::size_t> & neg_grow,
+                                std::size_t pos_size, std::size_t neg_size );
+    CRule prune_rule( const CRule & old_rule,
+                      const CDataset & X,
+                      const std::vector<std::size_t> & pos_prune,
+                      const std::vector<std::size_t> & neg_prune );
+    double rule_error( const CDataset & X,
+                       const CRule & rule,
+                       const std::vector<std::size_t> & pos_prune,
+                       const std::vector<std::size_t> & neg_prune ) const;
+    virtual std::vector<std::size_t> predict(
+                        const CRuleset & ruleset,
+                        const CDataset & X,
+                        std::size_t positive_class ) const;
+    /**
+     * @in: ruleset, dataset, positive class, number of threads
+     * - same as above, the rows are scored on n_threads threads
+     *   (0 uses all hardware threads), the overload above uses
+     *   the n_threads of the learner
+     */
+    virtual std::vector<std::size_t> predict(
+                        const CRuleset & ruleset,
+                        const CDataset & X,
+                        std::size_t positive_class,
+                        std::size_t n_threads ) const;
+    void set_pruning_metric( const std::string & metric );
+    /**
+     * @in: dataset, rule, pruning samples
+     * @out: value of the pruning metric of the rule
+     */
+    double pruning_metric( const CDataset & X,
+                           const CRule & rule,
+                           const std::vector<std::size_t> & pos_prune,
+                           const std::vector<std::size_t> & neg_prune ) const;
+    // split search on at most max_bins quantile bins per feature,
+    // 0 turns the histogram mode off
+    void set_histogram_bins( std::size_t max_bins );
+    double total_description_length( const CRuleset & ruleset,
+                                     const CDataset & X,
+                                     const std::vector<std::size_t> & y_true,
+                                     std::size_t positive_class ) const;
+    double total_description_length( const CRuleset & ruleset,
+                                     const CDataset & X,
+                                     const std::vector<std::size_t> & y_true,
+                                     std::size_t positive_class,
+                                     std::size_t conditions_count ) const;
+    /**
+     * @in: ruleset, number of possible conditions, confusion matrix
+     *      of the ruleset
+     * @out: total description length, see above
+     */
+    double total_description_length( const CRuleset & ruleset,
+                                     std::size_t conditions_count,
+                                     std::size_t tn, std::size_t fp,
+                                     std::size_t fn, std::size_t tp ) const;
+    double rule_bits( const CRule & rule, std::size_t conditions_count ) const;
+    double exception_bits( const CRuleset & ruleset,
+                           const CDataset & X,
+                           const std::vector<std::size_t> & y_true,
+                           std::size_t positive_class ) const;
+    double exception_bits( std::size_t tn, std::size_t fp,
+                           std::size_t fn, std::size_t tp ) const;
+    double exception_bits( const CConfusion & confusion ) const;
+    std::size_t unique_conditions( const CDataset & X ) const;
+
+    // nested vector adapters, X[feature][row] is copied into
+    // a CDataset and the call is forwarded
+    static void confusion_matrix( const CRuleset & ruleset,
+                                  std::size_t start_index,
+                                  const std::vector<std::vector<double>> & X,
+                                  const std::vector<std::size_t> & pos,
+                                  const std::vector<std::size_t> & neg, 
+                                  std::size_t & tn, std::size_t & fp,
+                                  std::size_t & fn, std::size_t & tp );
+    CRule grow_rule( const std::vector<std::vector<double>> & X,
+                     const std::vector<std::string> & feature_names,
+                     const std::vector<std::size_t> & pos_grow,
+                     const std::vector<std::size_t> & neg_grow );
     CRule grow_rule( const std::vector<std::vector<double>> & X,
                      const std::vector<std::string> & feature_names,
                      const std::vector<std::size_t> & pos_grow,
@@ -71,12 +337,6 @@ class CRuleLearner{
                                const std::vector<std::size_t> & pos_grow,
                                const std::vector<std::size_t> & neg_grow,
                                std::size_t pos_size, std::size_t neg_size );
-    void foil_metric( const std::map<double,std::size_t> & pos_sums,
-                      const std::map<double,std::size_t> & neg_sums,
-                      std::size_t pos_size, std::size_t neg_size,
-                      const std::string & feature, std::size_t index,
-                      const std::string & m_op, double & best_gain,
-                      CCondition *& best_cond ) const;
     CRule prune_rule( const CRule & old_rule,
                       const std::vector<std::vector<double>> & X,
                       const std::vector<std::size_t> & pos_prune,
@@ -85,11 +345,16 @@ class CRuleLearner{
                        const CRule & rule,
                        const std::vector<std::size_t> & pos_prune,
                        const std::vector<std::size_t> & neg_prune ) const;
-    virtual std::vector<std::size_t> predict(
+    std::vector<std::size_t> predict(
                         const CRuleset & ruleset,
                         const std::vector<std::vector<double>> & X,
                         std::size_t positive_class ) const;
-    void set_pruning_metric( const std::string & metric );
+    CRuleset fit_multiclass( const std::vector<std::vector<double>> & X,
+                             const std::vector<std::size_t> & Y,
+                             const std::vector<std::string> & feature_names );
+    std::vector<std::size_t> predict_multiclass(
+                        const CRuleset & ruleset,
+                        const std::vector<std::vector<double>> & X ) const;
     double total_description_length( const CRuleset & ruleset,
                                      const std::vector<std::vector<double>> & X,
                                      const std::vector<std::size_t> & y_true,
@@ -99,13 +364,10 @@ class CRuleLearner{
                                      const std::vector<std::size_t> & y_true,
                                      std::size_t positive_class,
                                      std::size_t conditions_count ) const;
-    double rule_bits( const CRule & rule, std::size_t conditions_count ) const;
     double exception_bits( const CRuleset & ruleset,
                            const std::vector<std::vector<double>> & X,
                            const std::vector<std::size_t> & y_true,
                            std::size_t positive_class ) const;
-    double exception_bits( std::size_t tn, std::size_t fp,
-                           std::size_t fn, std::size_t tp ) const;
     std::size_t unique_conditions( const std::vector<std::vector<double>> & X ) const;
 
   protected:
@@ -114,12 +376,187 @@ class CRuleLearner{
     std::size_t m_categorical_max; // maximum number of unique vals in a feature
     std::size_t m_difference;
     bool m_prune_rules; // should rules be pruned?
-    std::size_t m_n_threads;
-    std::function<double( const std::vector<std::vector<double>> & X,
-                          const CRule & rule,
-                          const std::vector<std::size_t> & pos_prune,
-                          const std::vector<std::size_t> & neg_prune )> m_pruning_metric;
+    std::size_t m_n_threads; // 0 uses all hardware threads
+    std::size_t m_max_bins; // histogram split search if non-zero
+    // pruning metric of ( P, N, p, n ), see utils.hpp
+    std::function<double( std::size_t P, std::size_t N,
+                          std::size_t p, std::size_t n )> m_pruning_metric;
     std::mt19937_64 m_rand_gen;
+    // per-fit structures, shared read-only by copies of the learner
+    std::shared_ptr<const CSortedIndex> m_sorted; // presorted features of
+                                                  // the dataset being fit
+    std::shared_ptr<const CBinnedDataset> m_binned; // binned features in
+                                                    // the histogram mode
+    std::shared_ptr<const CDatasetStats> m_stats; // column statistics of
+                                                  // the dataset being fit
+    /**
+     * (C)PoolSet keeps the thread pools of a learner by their number
+     * of threads, so repeated calls do not start and join threads.
+     * - a pool is created on first use, the mutex guards the creation,
+     *   so const methods (e.g. predict) can ask for one
+     */
+    class CPoolSet{
+      public:
+        /**
+         * @in: number of threads, 0 uses all hardware threads
+         * @out: pool of n_threads threads
+         */
+        CThreadPool * get( std::size_t n_threads );
+      private:
+        std::mutex m_mutex;
+        std::map<std::size_t, std::unique_ptr<CThreadPool>> m_pools;
+    };
+    std::shared_ptr<CPoolSet> m_pools; // shared by copies of the learner
+
+    /** return the thread pool, nullptr if the learner is single-threaded */
+    CThreadPool * thread_pool( void );
+    /** return a pool of n_threads threads, nullptr for a single thread */
+    CThreadPool * thread_pool( std::size_t n_threads ) const;
+
+    /**
+     * @in: compiled ruleset, class of every rule followed by the class
+     *      of rows no rule covers, dataset, number of threads
+     * @out: class of every row
+     * - the rows are scored by for_row_chunks, every worker writes
+     *   the classes of its chunk into the output
+     */
+    std::vector<std::size_t> predict_rows( const CCompiledRuleset & compiled,
+                                           const std::vector<std::size_t> & classes,
+                                           const CDataset & X,
+                                           std::size_t n_threads ) const;
+    /**
+     * @in: number of rows, number of threads, function of
+     *      ( first row, last row (exclusive) )
+     * - split the rows into chunks of whole tiles (see
+     *   CCompiledRuleset::covering_rules), a few per worker, and call
+     *   fn for every chunk on the pool of n_threads threads
+     * - the pool is kept by the learner for later calls
+     */
+    void for_row_chunks( std::size_t rows, std::size_t n_threads,
+                         const std::function<void( std::size_t, std::size_t )> & fn ) const;
+
+    /**
+     * (C)FitScope builds the per-fit structures of a learner
+     * (column statistics, presorted index or bins) on construction and releases them
+     * on destruction, so they never outlive the fitted dataset.
+     * - structures already built for the dataset (by an enclosing
+     *   scope) are reused, the destructor restores the previous ones
+     */
+    class CFitScope{
+      public:
+        CFitScope( CRuleLearner & learner, const CDataset & X );
+        ~CFitScope( void );
+      private:
+        CRuleLearner & m_learner;
+        std::shared_ptr<const CSortedIndex> m_sorted;
+        std::shared_ptr<const CBinnedDataset> m_binned;
+        std::shared_ptr<const CDatasetStats> m_stats;
+    };
+
+    /**
+     * @in: sorted groups of values of a feature (lowest and highest
+     *      value of every group), the number of positive and negative
+     *      samples in each group, true if each group holds one value
+     * - evaluate all conditions the feature offers ( { <=, >= }, or
+     *   { in } for exact categorical features ) by the FOIL gain,
+     *   both { <=, >= } come from a single prefix-sum sweep
+     */
+    void evaluate_counts( const std::vector<double> & lower,
+                          const std::vector<double> & upper,
+                          const std::vector<std::size_t> & pos_counts,
+                          const std::vector<std::size_t> & neg_counts,
+                          bool exact, std::size_t pos_size, std::size_t neg_size,
+                          std::size_t index, CSplitCandidate & best ) const;
+
+    /** buffers of a single feature scan, one set per worker */
+    struct CSplitScratch{
+      std::vector<double> values;
+      std::vector<double> lower_values; // lowest values of the bins
+      std::vector<std::size_t> pos_counts;
+      std::vector<std::size_t> neg_counts;
+      std::vector<std::size_t> pos_hist;
+      std::vector<std::size_t> neg_hist;
+      std::vector<std::pair<double,unsigned char>> pairs;
+    };
+
+    /**
+     * (C)ClassCounts keeps the number of positive and negative rows per
+     * value of every feature with few values (binned, dictionary-encoded
+     * or ranked by the presorted index) while a rule grows, so that an
+     * added condition only subtracts the rows it removed instead of
+     * recounting the remaining ones.
+     * - at most MaxValues values are tracked over all features, the
+     *   features past them are left to the split search
+     */
+    class CClassCounts{
+      public:
+        CClassCounts( const CRuleLearner & learner, const CDataset & X );
+        /** return true if no feature is tracked */
+        bool empty( void ) const;
+        /** return true if a given feature is tracked */
+        bool tracks( std::size_t idx ) const;
+        /** return number of values of a tracked feature */
+        std::size_t values( std::size_t idx ) const;
+        /** return counts of positive / negative rows per value */
+        const std::uint32_t * pos( std::size_t idx ) const;
+        const std::uint32_t * neg( std::size_t idx ) const;
+        /** count the given rows from scratch */
+        void assign( const std::vector<std::size_t> & pos_rows,
+                     const std::vector<std::size_t> & neg_rows );
+        /** subtract the given rows, they must have been counted */
+        void remove( const std::vector<std::size_t> & pos_rows,
+                     const std::vector<std::size_t> & neg_rows );
+
+        /** maximum number of values tracked over all features */
+        const static std::size_t MaxValues;
+      private:
+        std::vector<const std::uint8_t *> m_bins;   // bin codes per feature
+        std::vector<const std::uint32_t *> m_codes; // category codes
+        std::vector<const std::uint16_t *> m_ranks; // ranks of the presorted index
+        std::vector<std::size_t> m_offset; // start of a feature in m_pos, m_neg
+        std::vector<std::size_t> m_size;   // number of values, 0 if not tracked
+        std::vector<std::uint32_t> m_pos;
+        std::vector<std::uint32_t> m_neg;
+
+        /** add ( or subtract ) the rows to the counts of every feature */
+        void update( const std::vector<std::size_t> & rows,
+                     std::vector<std::uint32_t> & counts, bool add );
+    };
+
+    /**
+     * @in: number of rows a split search visits, number of features
+     * @out: true if find_split scans the features on the thread pool
+     * - a search of fewer rows visits at most as many, so tasks
+     *   running searches of their own can use it as well
+     */
+    bool parallel_split( std::size_t rows, std::size_t features ) const;
+
+    /**
+     * @in: dataset, number of features, samples, their sizes,
+     *      class counts of the samples ( or nullptr )
+     * - find_split, tracked features are evaluated from the counts
+     */
+    CSplitCandidate find_split( const CDataset & X,
+                                std::size_t features,
+                                const std::vector<std::size_t> & pos_grow,
+                                const std::vector<std::size_t> & neg_grow,
+                                std::size_t pos_size, std::size_t neg_size,
+                                const CClassCounts * counts );
+
+    /**
+     * @in: dataset, feature, samples, labels of the samples (sweep only),
+     *      class counts ( or nullptr ), scratch buffers, current best
+     *      candidate
+     * - count the samples per value of a single feature and evaluate
+     *   its conditions, see find_split
+     */
+    void scan_feature( const CDataset & X, std::size_t index,
+                       const std::vector<std::size_t> & pos_grow,
+                       const std::vector<std::size_t> & neg_grow,
+                       std::size_t pos_size, std::size_t neg_size,
+                       bool sweep, const std::vector<unsigned char> & labels,
+                       const CClassCounts * counts,
+                       CSplitScratch & scratch, CSplitCandidate & best ) const;
 };
 
 class CIREP : public CRuleLearner{
@@ -130,7 +567,9 @@ class CIREP : public CRuleLearner{
            std::size_t categorical_max=0, bool prune_rules=true,
            std::size_t n_threads=1,
            const std::string & pruning_metric="IREP_default" );
-    virtual CRuleset fit( const std::vector<std::vector<double>> & X,
+    using CRuleLearner::fit;
+    virtual CRuleLearner * clone( void ) const;
+    virtual CRuleset fit( const CDataset & X,
                           const std::vector<std::size_t> & Y,
                           const std::vector<std::string> & feature_names,
                           std::size_t positive_class );
@@ -144,17 +583,45 @@ class CRIPPER : public CRuleLearner{
              std::size_t categorical_max=0, std::size_t difference=64,
              std::size_t k=2, bool prune_rules=true, std::size_t n_threads=1, 
              const std::string & pruning_metric="RIPPER_default" );
-    CRuleset IREP_star( const std::vector<std::vector<double>> & X,
+    CRuleset IREP_star( const CDataset & X,
                         const std::vector<std::size_t> & Y,
                         const std::vector<std::size_t> pos,
                         const std::vector<std::size_t> neg,
                         const std::vector<std::string> & feature_names,
                         std::size_t positive_class,
                         const CRuleset & input_ruleset );
-    virtual CRuleset fit( const std::vector<std::vector<double>> & X,
+    virtual CRuleLearner * clone( void ) const;
+    virtual bool uses_description_length( void ) const;
+    virtual CRuleset fit( const CDataset & X,
                           const std::vector<std::size_t> & Y,
                           const std::vector<std::string> & feature_names,
                           std::size_t positive_class );
+    CRuleset optimise_ruleset( const CRuleset & input_ruleset,
+                               const CDataset & X,
+                               const std::vector<std::size_t> & Y,
+                               const std::vector<std::string> & feature_names,
+                               const std::vector<std::size_t> & pos,
+                               const std::vector<std::size_t> & neg,
+                               std::size_t positive_class );
+    CRule optimise_prune( const CRuleset & input_ruleset,
+                          std::size_t index,
+                          const CDataset & X,
+                          const std::vector<std::size_t> & pos_prune,
+                          const std::vector<std::size_t> & neg_prune );
+    CRuleset generalise_ruleset( const CRuleset & input_ruleset,
+                                 const CDataset & X, 
+                                 const std::vector<std::size_t> & Y,
+                                 std::size_t positive_class ) const;
+
+    // nested vector adapters
+    using CRuleLearner::fit;
+    CRuleset IREP_star( const std::vector<std::vector<double>> & X,
+                        const std::vector<std::size_t> & Y,
+                        const std::vector<std::size_t> pos,
+                        const std::vector<std::size_t> neg,
+                        const std::vector<std::string> & feature_names,
+                        std::size_t positive_class,
+                        const CRuleset & input_ruleset );
     CRuleset optimise_ruleset( const CRuleset & input_ruleset,
                                const std::vector<std::vector<double>> & X,
                                const std::vector<std::size_t> & Y,
@@ -185,7 +652,10 @@ class CCompetitor : public CRuleLearner{
                  std::size_t categorical_max=0, std::size_t difference=64,
                  bool prune_rules=true, std::size_t n_threads=1,
                  const std::string & pruning_metric="RIPPER_default" );
-    virtual CRuleset fit( const std::vector<std::vector<double>> & X,
+    using CRuleLearner::fit;
+    virtual CRuleLearner * clone( void ) const;
+    virtual bool uses_description_length( void ) const;
+    virtual CRuleset fit( const CDataset & X,
                           const std::vector<std::size_t> & Y,
                           const std::vector<std::string> & feature_names,
                           std::size_t positive_class );
@@ -195,15 +665,35 @@ class COneR : public CRuleLearner{
 
   public:
     COneR( void );
-    virtual CRuleset fit( const std::vector<std::vector<double>> & X,
+    /** @in: number of threads predict runs on, 0 uses all hardware threads */
+    explicit COneR( std::size_t n_threads );
+    virtual CRuleLearner * clone( void ) const;
+    virtual CRuleset fit( const CDataset & X,
                           const std::vector<std::size_t> & Y,
                           const std::vector<std::string> & feature_names,
                           std::size_t positive_class );
     virtual std::vector<std::size_t> predict( 
                         const CRuleset & ruleset,
-                        const std::vector<std::vector<double>> & X,
+                        const CDataset & X,
                         std::size_t positive_class ) const;
     virtual std::vector<std::size_t> predict( 
+                        const CRuleset & ruleset,
+                        const CDataset & X ) const;
+    /**
+     * @in: ruleset, dataset, positive class (unused, the rules carry
+     *      their classes), number of threads
+     * - the overloads above use the n_threads of the learner
+     */
+    virtual std::vector<std::size_t> predict(
+                        const CRuleset & ruleset,
+                        const CDataset & X,
+                        std::size_t positive_class,
+                        std::size_t n_threads ) const;
+
+    // nested vector adapters
+    using CRuleLearner::fit;
+    using CRuleLearner::predict;
+    std::vector<std::size_t> predict( 
                         const CRuleset & ruleset,
                         const std::vector<std::vector<double>> & X ) const;
 
@@ -214,7 +704,7 @@ class COneR : public CRuleLearner{
     // categorical max?
 
     CRuleset discretise( std::size_t row,
-                         const std::vector<std::vector<double>> & X,
+                         const CDataset & X,
                          const std::vector<std::size_t> & Y,
                          const std::vector<std::string> & feature_names,
                          std::size_t positive_class,
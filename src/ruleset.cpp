@@ -7,39 +7,81 @@ const std::vector<std::string> CCondition::Operators{
   "<=", ">=","range", "in"
 };
 
+template<>
+struct CCondition::CTest<CCondition::EOperator::LE>{
+  double upper;
+  explicit CTest( const CCondition & c ): upper( c.m_con_vals.front() ){}
+  bool operator()( double x ) const{ return x <= upper; }
+};
+
+template<>
+struct CCondition::CTest<CCondition::EOperator::GE>{
+  double lower;
+  explicit CTest( const CCondition & c ): lower( c.m_con_vals.front() ){}
+  bool operator()( double x ) const{ return x >= lower; }
+};
+
+template<>
+struct CCondition::CTest<CCondition::EOperator::RANGE>{
+  double lower, upper;
+  explicit CTest( const CCondition & c ):
+      lower( c.m_con_vals[0] ), upper( c.m_con_vals[1] ){}
+  bool operator()( double x ) const{ return x >= lower && x <= upper; }
+};
+
+template<>
+struct CCondition::CTest<CCondition::EOperator::IN>{
+  // contiguous copy of the set, searched by bisection once
+  // the linear scan gets longer than a few cache lines
+  std::vector<double> vals;
+  explicit CTest( const CCondition & c ):
+      vals( c.m_cat_vals.begin(), c.m_cat_vals.end() ){}
+  bool operator()( double x ) const{
+    // NaN is unordered, the bisection would take it for a match
+    if( vals.size() > 16 )
+      return x == x && std::binary_search( vals.begin(), vals.end(), x );
+    for( const auto & val : vals )
+      if( x == val )
+        return true;
+    return false;
+  }
+};
+
 CCondition::CCondition( const std::string & feature, std::size_t index,
                         const std::string & op, double val ):
-    m_f( feature ), m_ind( index ){
+    CCondition( feature, index, parse_operator( op ), val ){
+}
 
-  //check operator
-  if( check_operator( op ) && op != "range" )
-    m_op = op;
-  else
+CCondition::CCondition( const std::string & feature, std::size_t index,
+                        const std::string & op, const std::vector<double> & vals ):
+    CCondition( feature, index, parse_operator( op ), vals ){
+}
+
+CCondition::CCondition( const std::string & feature, std::size_t index,
+                        EOperator op, double val ):
+    m_f( feature ), m_ind( index ), m_op( op ){
+
+  if( m_op == EOperator::RANGE )
     throw std::invalid_argument("Wrong operator!");
 
-  if( m_op == "in" )
+  if( m_op == EOperator::IN )
     m_cat_vals.insert( val );
   else
     m_con_vals.push_back( val );
 }
 
 CCondition::CCondition( const std::string & feature, std::size_t index,
-                        const std::string & op, const std::vector<double> & vals ):
-    m_f( feature ), m_ind( index ){
-
-  if( op != "range" && op != "in" )
-    throw std::invalid_argument("Wrong operator!");
+                        EOperator op, const std::vector<double> & vals ):
+    m_f( feature ), m_ind( index ), m_op( op ){
 
-  m_op = op;
-
-  if( op == "range" ){
+  if( op == EOperator::RANGE ){
 
     if( vals.size() != 2 )
       throw std::length_error("Invalid vector length!");
 
     m_con_vals = vals;
   }
-  else if( op == "in" ){
+  else if( op == EOperator::IN ){
     
     if( vals.size() == 0 )
       throw std::length_error("Invalid vector length!");
@@ -47,6 +89,8 @@ CCondition::CCondition( const std::string & feature, std::size_t index,
     for( const auto & x: vals )
       m_cat_vals.insert( x ); 
   }
+  else
+    throw std::invalid_argument("Wrong operator!");
 }
 
 CCondition::CCondition( const CCondition & src ){
@@ -66,31 +110,43 @@ std::size_t CCondition::get_index( void ) const{
 }
 
 std::string CCondition::get_operator( void ) const{
+  return operator_name( m_op );
+}
+
+CCondition::EOperator CCondition::get_operator_code( void ) const{
   return m_op;
 }
 
 std::vector<double> CCondition::get_values( void ) const{
-  if( m_op == "in" )
+  if( m_op == EOperator::IN )
     return std::vector<double>( m_cat_vals.begin(), m_cat_vals.end() );
 
   return m_con_vals;
 }
 
 bool CCondition::modify( const std::string & op, double val ){
+  return modify( parse_operator( op ), val );
+}
+
+bool CCondition::modify( EOperator op, double val ){
 
   // check the input operator
-  if( ! check_operator( op ) || op == "range" ){
+  if( op == EOperator::RANGE ){
     throw std::invalid_argument("Wrong operator!");
     return false;
   }
 
-  if( m_op == "range" ){
-    // change lowerbound
-    if( op == ">=" && m_con_vals.size() == 2 && val > m_con_vals[0] )
-      m_con_vals[0] = val;
-    // change upperbound
-    else if( op == "<=" && m_con_vals.size() == 2 && val < m_con_vals[1] )
-      m_con_vals[1] = val;
+  if( m_op == EOperator::RANGE ){
+    // change lowerbound, a looser bound is ignored as for { >= }
+    if( op == EOperator::GE && m_con_vals.size() == 2 ){
+      if( val > m_con_vals[0] )
+        m_con_vals[0] = val;
+    }
+    // change upperbound, a looser bound is ignored as for { <= }
+    else if( op == EOperator::LE && m_con_vals.size() == 2 ){
+      if( val < m_con_vals[1] )
+        m_con_vals[1] = val;
+    }
     // other operators than { <=, >= } cannot be combined with
     // { range }
     else{
@@ -98,29 +154,29 @@ bool CCondition::modify( const std::string & op, double val ){
       return false;
     }
   }
-  else if( op == ">=" ){
+  else if( op == EOperator::GE ){
     // change lowerbound
-    if( m_op == ">=" && m_con_vals.size() == 1 && val > m_con_vals[0] )
+    if( m_op == EOperator::GE && m_con_vals.size() == 1 && val > m_con_vals[0] )
       m_con_vals[0] = val;
     // add upperbound, one may create an invalid condition,
     // such as x >= 3 && x <= 2;
     // change the inner operator type
-    else if( m_op == "<=" && m_con_vals.size() == 1 ){
-      m_op = "range";
+    else if( m_op == EOperator::LE && m_con_vals.size() == 1 ){
+      m_op = EOperator::RANGE;
       m_con_vals.insert( m_con_vals.begin(), val );
     }
   }
-  else if( op == "<=" ){
+  else if( op == EOperator::LE ){
     // change upperbound
-    if( m_op == "<=" && m_con_vals.size() == 1 && val < m_con_vals[0] )
+    if( m_op == EOperator::LE && m_con_vals.size() == 1 && val < m_con_vals[0] )
       m_con_vals[0] = val;
     // add lowerbound, see above comment for `op == ">="`
-    else if( m_op == ">=" && m_con_vals.size() == 1 ){
-      m_op = "range";
+    else if( m_op == EOperator::GE && m_con_vals.size() == 1 ){
+      m_op = EOperator::RANGE;
       m_con_vals.push_back( val );
     }
   }
-  else if( op == "in" && m_op == "in" )
+  else if( op == EOperator::IN && m_op == EOperator::IN )
     return m_cat_vals.insert( val ).second;
   else{
     throw std::invalid_argument("Could not deduce operator use!");
@@ -135,15 +191,15 @@ bool CCondition::modify( const CCondition & src ){
 
   bool a = true;
 
-  if( src.m_op == "range" ){
+  if( src.m_op == EOperator::RANGE ){
     //TODO may leave the condition inconsistent?
-    a &= modify( ">=", src.m_con_vals[0] );
-    a &= modify( "<=", src.m_con_vals[1] );
+    a &= modify( EOperator::GE, src.m_con_vals[0] );
+    a &= modify( EOperator::LE, src.m_con_vals[1] );
   }
-  else if( src.m_op == "in" )
+  else if( src.m_op == EOperator::IN )
     m_cat_vals.insert( src.m_cat_vals.begin(),
                        src.m_cat_vals.end() );
-  else if( src.m_op == "<=" || src.m_op == ">=" )
+  else if( src.m_op == EOperator::LE || src.m_op == EOperator::GE )
     a &= modify( src.m_op, src.m_con_vals.front() );
   else
     return false;
@@ -157,7 +213,7 @@ bool CCondition::operator==( const CCondition & x ) const{
   if( &x == this )
     return true;
 
-  if( m_f == x.m_f && m_ind == x.m_ind && m_op == x.m_op &&
+  if( m_ind == x.m_ind && m_op == x.m_op && m_f == x.m_f &&
       m_con_vals == x.m_con_vals &&
       m_cat_vals == x.m_cat_vals )
     return true;
@@ -184,15 +240,15 @@ CCondition & CCondition::operator=( const CCondition & src ){
 std::string CCondition::to_string( void ) const{
 
   std::string out;
-  out = m_f + "[" + std::to_string( m_ind ) + "] " + m_op;
+  out = m_f + "[" + std::to_string( m_ind ) + "] " + operator_name( m_op );
   out += " ";
 
-  if( m_op == ">=" || m_op == "<=" )
+  if( m_op == EOperator::GE || m_op == EOperator::LE )
     out += std::to_string( m_con_vals.front() );
-  else if( m_op == "range" )
+  else if( m_op == EOperator::RANGE )
     out += "[" + std::to_string( m_con_vals[0] ) + ", " +
            std::to_string( m_con_vals[1] ) + "]";
-  else if( m_op == "in" ){
+  else if( m_op == EOperator::IN ){
     out += "{";
     for( const auto & x: m_cat_vals )
       out += " " + std::to_string( x ) + ",";
@@ -206,94 +262,338 @@ std::string CCondition::to_string( void ) const{
 std::vector<std::size_t> CCondition::covered_indices(
     const std::vector<std::vector<double>> & data,
     const std::vector<std::size_t> & input_indices ) const{
-
-  // TODO prefixed size? e.g. 1/2 of input_indices.size()
-  std::vector<std::size_t> indices;
-  auto & row = data[m_ind];
-
-  // determine which condition ( <= ... ) needs to be used
-  //   for x in indices
-  //     for every index that the condition applies to insert it
-  //     into a vector
-  // even though this looks kinda ugly we don't want to compare
-  // the operator each time
-  if( m_op == "<=" ){
-    auto & upper = m_con_vals.front();
-    for( const auto & i : input_indices )
-      if( row[i] <= upper )
-        indices.push_back( i );
+  return covered_indices( data[m_ind].data(), input_indices );
+}
+
+/**
+ * @in: data indices, predicate on row indices, output buffers
+ * - single pass over the input, a null buffer is not filled
+ * - the buffers keep their capacity, either of them may be the
+ *   input itself as long as the other one is not (the write
+ *   position never overtakes the read position)
+ */
+template<typename Predicate>
+void split_where( const std::vector<std::size_t> & input, Predicate pred,
+                  std::vector<std::size_t> * covered,
+                  std::vector<std::size_t> * not_covered ){
+
+  std::size_t n = input.size(), c = 0, u = 0;
+
+  if( covered && covered != &input )
+    covered -> resize( n );
+  if( not_covered && not_covered != &input )
+    not_covered -> resize( n );
+
+  for( std::size_t i = 0; i < n; ++i ){
+    std::size_t idx = input[i];
+    if( pred( idx ) ){
+      if( covered )
+        (*covered)[c++] = idx;
+    }
+    else if( not_covered )
+      (*not_covered)[u++] = idx;
   }
-  else if( m_op == ">=" ){
-    auto & lower = m_con_vals.front();
-    for( const auto & i : input_indices )
-      if( row[i] >= lower )
-        indices.push_back( i );
+
+  if( covered )
+    covered -> resize( c );
+  if( not_covered )
+    not_covered -> resize( u );
+}
+
+/**
+ * @in: data indices, their subsequence, output buffer
+ * - writes the indices of the input missing in the subsequence,
+ *   out may be the input itself
+ */
+void complement_of( const std::vector<std::size_t> & input,
+                    const std::vector<std::size_t> & subsequence,
+                    std::vector<std::size_t> & out ){
+
+  std::size_t n = input.size(), k = 0, u = 0;
+
+  if( &out != &input )
+    out.resize( n );
+
+  for( std::size_t i = 0; i < n; ++i ){
+    std::size_t idx = input[i];
+    if( k < subsequence.size() && subsequence[k] == idx )
+      ++k;
+    else
+      out[u++] = idx;
   }
-  else if( m_op == "range" ){
-    auto & lower = m_con_vals[0];
-    auto & upper = m_con_vals[1];
-    for( const auto & i : input_indices )
-      if( row[i] >= lower && row[i] <= upper )
-        indices.push_back( i );
+
+  out.resize( u );
+}
+
+void CCondition::split( const CDataset & data,
+                        const std::vector<std::size_t> & input_indices,
+                        std::vector<std::size_t> * covered,
+                        std::vector<std::size_t> * not_covered ) const{
+
+  const double * row = data.column( m_ind );
+
+  switch( m_op ){
+    case EOperator::LE:{
+      CTest<EOperator::LE> test( *this );
+      split_where( input_indices, [&]( std::size_t i ){ return test( row[i] ); },
+                   covered, not_covered );
+      return;
+    }
+    case EOperator::GE:{
+      CTest<EOperator::GE> test( *this );
+      split_where( input_indices, [&]( std::size_t i ){ return test( row[i] ); },
+                   covered, not_covered );
+      return;
+    }
+    case EOperator::RANGE:{
+      CTest<EOperator::RANGE> test( *this );
+      split_where( input_indices, [&]( std::size_t i ){ return test( row[i] ); },
+                   covered, not_covered );
+      return;
+    }
+    case EOperator::IN:{
+      if( data.encoded( m_ind ) ){
+        const std::uint32_t * codes = data.codes( m_ind );
+        std::vector<std::uint64_t> bits = category_bits( data.categories( m_ind ) );
+        split_where( input_indices,
+                     [&]( std::size_t i ){
+                       return ( bits[codes[i] >> 6] >> ( codes[i] & 63 ) ) & 1;
+                     },
+                     covered, not_covered );
+        return;
+      }
+      CTest<EOperator::IN> test( *this );
+      split_where( input_indices, [&]( std::size_t i ){ return test( row[i] ); },
+                   covered, not_covered );
+      return;
+    }
   }
-  else if( m_op == "in" ){
-    for( const auto & i : input_indices )
-      for( const auto & val : m_cat_vals )
-        if( row[i] == val ){
-          indices.push_back( i );
-          break;
-        }
+
+  throw std::runtime_error( "Unknown operator encountered" );
+}
+
+std::vector<std::size_t> CCondition::covered_indices(
+    const CDataset & data,
+    const std::vector<std::size_t> & input_indices ) const{
+  std::vector<std::size_t> indices;
+  split( data, input_indices, &indices, nullptr );
+  return indices;
+}
+
+void CCondition::covered_indices( const CDataset & data,
+                                  const std::vector<std::size_t> & input_indices,
+                                  std::vector<std::size_t> & covered ) const{
+  split( data, input_indices, &covered, nullptr );
+}
+
+void CCondition::partition( const CDataset & data,
+                            const std::vector<std::size_t> & input_indices,
+                            std::vector<std::size_t> & covered,
+                            std::vector<std::size_t> & not_covered ) const{
+  if( &not_covered == &input_indices || &not_covered == &covered )
+    throw std::invalid_argument( "Output buffers overlap!" );
+  split( data, input_indices, &covered, &not_covered );
+}
+
+std::vector<std::uint64_t> CCondition::category_bits(
+    const std::vector<double> & categories ) const{
+
+  std::vector<std::uint64_t> bits( categories.size() / 64 + 1, 0 );
+
+  // values missing in the dictionary cannot match any row
+  for( const auto & val : m_cat_vals ){
+    auto it = std::lower_bound( categories.begin(), categories.end(), val );
+    if( it != categories.end() && *it == val ){
+      std::size_t code = it - categories.begin();
+      bits[code >> 6] |= (std::uint64_t)1 << ( code & 63 );
+    }
   }
-  else
-    throw std::runtime_error( "Unknown operator encountered" );
+
+  return bits;
+}
+
+template<CCondition::EOperator Op, bool Covered>
+std::vector<std::size_t> CCondition::filter(
+    const double * row,
+    const std::vector<std::size_t> & input_indices ) const{
+
+  // TODO prefixed size? e.g. 1/2 of input_indices.size()
+  std::vector<std::size_t> indices;
+  CTest<Op> test( *this );
+
+  for( const auto & i : input_indices )
+    if( test( row[i] ) == Covered )
+      indices.push_back( i );
 
   return indices;
 }
 
+std::vector<std::size_t> CCondition::covered_indices(
+    const double * row,
+    const std::vector<std::size_t> & input_indices ) const{
+
+  // the operator is resolved once, the loop itself is
+  // specialised for it
+  switch( m_op ){
+    case EOperator::LE:
+      return filter<EOperator::LE, true>( row, input_indices );
+    case EOperator::GE:
+      return filter<EOperator::GE, true>( row, input_indices );
+    case EOperator::RANGE:
+      return filter<EOperator::RANGE, true>( row, input_indices );
+    case EOperator::IN:
+      return filter<EOperator::IN, true>( row, input_indices );
+  }
+
+  throw std::runtime_error( "Unknown operator encountered" );
+}
+
 std::vector<std::size_t> CCondition::not_covered_indices(
     const std::vector<std::vector<double>> & data,
     const std::vector<std::size_t> & input_indices ) const{
+  return not_covered_indices( data[m_ind].data(), input_indices );
+}
 
-  // TODO prefixed size? e.g. 1/2 of input_indices.size()
+std::vector<std::size_t> CCondition::not_covered_indices(
+    const CDataset & data,
+    const std::vector<std::size_t> & input_indices ) const{
   std::vector<std::size_t> indices;
-  auto & row = data[m_ind];
+  split( data, input_indices, nullptr, &indices );
+  return indices;
+}
 
-  if( m_op == "<=" ){
-    auto & upper = m_con_vals.front();
-    for( const auto & i : input_indices )
-      if( !( row[i] <= upper ) )
-        indices.push_back( i );
+std::vector<std::size_t> CCondition::not_covered_indices(
+    const double * row,
+    const std::vector<std::size_t> & input_indices ) const{
+
+  switch( m_op ){
+    case EOperator::LE:
+      return filter<EOperator::LE, false>( row, input_indices );
+    case EOperator::GE:
+      return filter<EOperator::GE, false>( row, input_indices );
+    case EOperator::RANGE:
+      return filter<EOperator::RANGE, false>( row, input_indices );
+    case EOperator::IN:
+      return filter<EOperator::IN, false>( row, input_indices );
   }
-  else if( m_op == ">=" ){
-    auto & lower = m_con_vals.front();
-    for( const auto & i : input_indices )
-      if( !( row[i] >= lower ) )
-        indices.push_back( i );
+
+  throw std::runtime_error( "Unknown operator encountered" );
+}
+
+/**
+ * @in: input coverage, dense kernel, predicate on row indices
+ * @out: rows of the input for which the predicate holds
+ * - a dense input is scanned word by word with the kernel
+ *   (see kernels.hpp), the rows of the last incomplete word are
+ *   left to the predicate
+ * - otherwise only the set bits of the input are evaluated
+ */
+template<typename Kernel, typename Predicate>
+CCoverage mask_where( const CCoverage & input, Kernel kernel, Predicate pred ){
+
+  CCoverage out( input.size() );
+  const std::uint64_t * in_words = input.data();
+  std::uint64_t * out_words = out.data();
+
+  // share of covered rows from which a full scan is cheaper
+  // than visiting the covered rows one by one
+  const std::size_t dense_ratio = 8;
+
+  if( input.count() * dense_ratio >= input.size() ){
+    std::size_t full = input.size() / CCoverage::WordBits;
+    kernel( full, out_words );
+    for( std::size_t i = 0; i < full; ++i )
+      out_words[i] &= in_words[i];
+    if( full == input.words() )
+      return out;
+    in_words += full;
+    out_words += full;
+    for( std::uint64_t w = *in_words; w; w &= w - 1 ){
+      std::size_t b = CCoverage::lowest_bit( w );
+      if( pred( full * CCoverage::WordBits + b ) )
+        *out_words |= (std::uint64_t)1 << b;
+    }
+    return out;
   }
-  else if( m_op == "range" ){
-    auto & lower = m_con_vals[0];
-    auto & upper = m_con_vals[1];
-    for( const auto & i : input_indices )
-      if( !( row[i] >= lower && row[i] <= upper ) )
-        indices.push_back( i );
+
+  for( std::size_t i = 0; i < input.words(); ++i ){
+    std::uint64_t bits = 0;
+    for( std::uint64_t w = in_words[i]; w; w &= w - 1 ){
+      std::size_t b = CCoverage::lowest_bit( w );
+      if( pred( i * CCoverage::WordBits + b ) )
+        bits |= (std::uint64_t)1 << b;
+    }
+    out_words[i] = bits;
   }
-  else if( m_op == "in" ){
-    for( const auto & i : input_indices ){
-      bool flag = false;
-      for( const auto & val : m_cat_vals )
-        if( row[i] == val ){
-          flag = true;
-          break;
-        }
-      if( ! flag )
-        indices.push_back( i );
+
+  return out;
+}
+
+CCoverage CCondition::covered_mask( const CDataset & data,
+                                    const CCoverage & input ) const{
+
+  if( input.size() != data.rows() )
+    throw std::invalid_argument( "Coverage and data sizes differ!" );
+
+  const double * row = data.column( m_ind );
+
+  switch( m_op ){
+    case EOperator::LE:{
+      CTest<EOperator::LE> test( *this );
+      return mask_where( input,
+        [&]( std::size_t words, std::uint64_t * out ){
+          le_mask( row, words, test.upper, out );
+        },
+        [&]( std::size_t i ){ return test( row[i] ); } );
+    }
+    case EOperator::GE:{
+      CTest<EOperator::GE> test( *this );
+      return mask_where( input,
+        [&]( std::size_t words, std::uint64_t * out ){
+          ge_mask( row, words, test.lower, out );
+        },
+        [&]( std::size_t i ){ return test( row[i] ); } );
+    }
+    case EOperator::RANGE:{
+      CTest<EOperator::RANGE> test( *this );
+      return mask_where( input,
+        [&]( std::size_t words, std::uint64_t * out ){
+          range_mask( row, words, test.lower, test.upper, out );
+        },
+        [&]( std::size_t i ){ return test( row[i] ); } );
+    }
+    case EOperator::IN:{
+      if( data.encoded( m_ind ) ){
+        const std::uint32_t * codes = data.codes( m_ind );
+        std::vector<std::uint64_t> bits = category_bits( data.categories( m_ind ) );
+        return mask_where( input,
+          [&]( std::size_t words, std::uint64_t * out ){
+            code_mask( codes, words, bits.data(), out );
+          },
+          [&]( std::size_t i ){
+            return ( bits[codes[i] >> 6] >> ( codes[i] & 63 ) ) & 1;
+          } );
+      }
+      CTest<EOperator::IN> test( *this );
+      const std::vector<double> & values = test.vals;
+      return mask_where( input,
+        [&]( std::size_t words, std::uint64_t * out ){
+          in_mask( row, words, values, out );
+        },
+        [&]( std::size_t i ){ return test( row[i] ); } );
     }
   }
-  else
-    throw std::runtime_error( "Unknown operator encountered" );
 
-  return indices;
+  throw std::runtime_error( "Unknown operator encountered" );
+}
+
+CCoverage CCondition::not_covered_mask( const CDataset & data,
+                                        const CCoverage & input ) const{
+  CCoverage out( input );
+  out.and_not( covered_mask( data, input ) );
+  return out;
 }
+
 std::ostream & operator<<( std::ostream & out, const CCondition & src ){
 
   out << src.to_string();
@@ -301,14 +601,18 @@ std::ostream & operator<<( std::ostream & out, const CCondition & src ){
   return out;
 }
 
-bool CCondition::check_operator( const std::string & op ) const{
+CCondition::EOperator CCondition::parse_operator( const std::string & op ){
 
   //check available operators
-  for( const auto & x: CCondition::Operators )
-    if( x == op )
-      return true;
-  
-  return false;
+  for( std::size_t i = 0; i < Operators.size(); ++i )
+    if( Operators[i] == op )
+      return static_cast<EOperator>( i );
+
+  throw std::invalid_argument("Wrong operator!");
+}
+
+const std::string & CCondition::operator_name( EOperator op ){
+  return Operators[ static_cast<std::size_t>( op ) ];
 }
 
 CRule::CRule( void ):
@@ -405,6 +709,10 @@ bool CRule::predicts_the_same( const CRule & x ) const{
 
 }
 
+bool CRule::shows_class( void ) const{
+  return m_show_class;
+}
+
 std::string CRule::to_string( void ) const{
 
   std::string out;
@@ -492,6 +800,81 @@ std::vector<std::size_t> CRule::not_covered_indices(
   return diff;
 }
 
+std::vector<std::size_t> CRule::covered_indices( 
+    const CDataset & data,
+    const std::vector<std::size_t> & input_indices ) const{
+
+  std::vector<std::size_t> indices;
+  covered_indices( data, input_indices, indices );
+  return indices;
+}
+
+std::vector<std::size_t> CRule::not_covered_indices(
+    const CDataset & data,
+    const std::vector<std::size_t> & input_indices ) const{
+
+  std::vector<std::size_t> indices;
+  not_covered_indices( data, input_indices, indices );
+  return indices;
+}
+
+void CRule::covered_indices( const CDataset & data,
+                             const std::vector<std::size_t> & input_indices,
+                             std::vector<std::size_t> & covered ) const{
+
+  if( m_cond.empty() ){
+    if( &covered != &input_indices )
+      covered = input_indices;
+    return;
+  }
+
+  // the first condition reads the input, the others filter in place
+  auto it = m_cond.begin();
+  it -> second . covered_indices( data, input_indices, covered );
+  for( ++it; it != m_cond.end() && ! covered.empty(); ++it )
+    it -> second . covered_indices( data, covered, covered );
+}
+
+void CRule::not_covered_indices( const CDataset & data,
+                                 const std::vector<std::size_t> & input_indices,
+                                 std::vector<std::size_t> & not_covered ) const{
+
+  std::vector<std::size_t> covered;
+  covered_indices( data, input_indices, covered );
+  complement_of( input_indices, covered, not_covered );
+}
+
+void CRule::partition( const CDataset & data,
+                       const std::vector<std::size_t> & input_indices,
+                       std::vector<std::size_t> & covered,
+                       std::vector<std::size_t> & not_covered ) const{
+
+  if( &covered == &input_indices || &not_covered == &input_indices ||
+      &covered == &not_covered )
+    throw std::invalid_argument( "Output buffers overlap!" );
+
+  covered_indices( data, input_indices, covered );
+  complement_of( input_indices, covered, not_covered );
+}
+
+CCoverage CRule::covered_mask( const CDataset & data,
+                               const CCoverage & input ) const{
+
+  CCoverage mask( input );
+
+  for( const auto & c : m_cond )
+    mask = c.second.covered_mask( data, mask );
+
+  return mask;
+}
+
+CCoverage CRule::not_covered_mask( const CDataset & data,
+                                   const CCoverage & input ) const{
+  CCoverage out( input );
+  out.and_not( covered_mask( data, input ) );
+  return out;
+}
+
 std::map<std::size_t,CCondition>::iterator CRule::i_begin( void ){
   return m_cond.begin();
 }
@@ -663,6 +1046,82 @@ std::vector<std::size_t> CRuleset::not_covered_indices(
 
   return indices;
 }
+std::vector<std::size_t> CRuleset::covered_indices(
+    const CDataset & data,
+    const std::vector<std::size_t> & input_indices ) const{
+
+  std::vector<std::size_t> indices;
+  covered_indices( data, input_indices, indices );
+  return indices;
+}
+
+std::vector<std::size_t> CRuleset::not_covered_indices(
+    const CDataset & data,
+    const std::vector<std::size_t> & input_indices ) const{
+
+  std::vector<std::size_t> indices;
+  not_covered_indices( data, input_indices, indices );
+  return indices;
+}
+
+void CRuleset::covered_indices( const CDataset & data,
+                                const std::vector<std::size_t> & input_indices,
+                                std::vector<std::size_t> & covered ) const{
+
+  std::vector<std::size_t> not_covered;
+  not_covered_indices( data, input_indices, not_covered );
+  complement_of( input_indices, not_covered, covered );
+}
+
+void CRuleset::not_covered_indices( const CDataset & data,
+                                    const std::vector<std::size_t> & input_indices,
+                                    std::vector<std::size_t> & not_covered ) const{
+
+  if( &not_covered != &input_indices )
+    not_covered = input_indices;
+
+  // rows covered by a rule are removed before the next one,
+  // the scratch buffer is shared by all the rules
+  std::vector<std::size_t> covered;
+  for( const auto & r: m_rules ){
+    if( not_covered.empty() )
+      break;
+    r.covered_indices( data, not_covered, covered );
+    complement_of( not_covered, covered, not_covered );
+  }
+}
+
+void CRuleset::partition( const CDataset & data,
+                          const std::vector<std::size_t> & input_indices,
+                          std::vector<std::size_t> & covered,
+                          std::vector<std::size_t> & not_covered ) const{
+
+  if( &covered == &input_indices || &not_covered == &input_indices ||
+      &covered == &not_covered )
+    throw std::invalid_argument( "Output buffers overlap!" );
+
+  not_covered_indices( data, input_indices, not_covered );
+  complement_of( input_indices, not_covered, covered );
+}
+
+CCoverage CRuleset::covered_mask( const CDataset & data,
+                                  const CCoverage & input ) const{
+  CCoverage out( input );
+  out.and_not( not_covered_mask( data, input ) );
+  return out;
+}
+
+CCoverage CRuleset::not_covered_mask( const CDataset & data,
+                                      const CCoverage & input ) const{
+
+  CCoverage mask( input );
+
+  for( const auto & r: m_rules )
+    mask.and_not( r.covered_mask( data, mask ) );
+
+  return mask;
+}
+
 std::ostream & operator<<( std::ostream & out, const CRuleset & src ){
   out << src.to_string();
   return out;
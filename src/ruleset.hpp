@@ -10,6 +10,10 @@
 #include <ostream>
 #include <algorithm>
 #include <iterator>
+#include <cstdint>
+#include "./dataset.hpp"
+#include "./coverage.hpp"
+#include "./kernels.hpp"
 
 #ifdef __verbose__
   #include "logger.hpp"
@@ -28,6 +32,13 @@
 class CCondition{
 
   public:
+    /**
+     * Operator codes, in the order of Operators (see below).
+     * The learners work with the codes, the string form is
+     * kept for to_string() and the Python bindings.
+     */
+    enum class EOperator : std::uint8_t { LE, GE, RANGE, IN };
+
     /**
      * @in: feature name, index in matrix,
      *      used operator, given value
@@ -46,6 +57,11 @@ class CCondition{
      */
     CCondition( const std::string & feature, std::size_t index,
                 const std::string & op, const std::vector<double> & vals );
+    /** same as above, the operator is given by its code */
+    CCondition( const std::string & feature, std::size_t index,
+                EOperator op, double val );
+    CCondition( const std::string & feature, std::size_t index,
+                EOperator op, const std::vector<double> & vals );
     /**
      * @in: CCondition
      * - deep copy constructor
@@ -57,6 +73,8 @@ class CCondition{
     std::size_t get_index( void ) const;
     /** return operator */
     std::string get_operator( void ) const;
+    /** return operator code */
+    EOperator get_operator_code( void ) const;
     /** return values */
     std::vector<double> get_values( void ) const;
     /**
@@ -67,8 +85,11 @@ class CCondition{
      *   file_size[5] range [0.7, 0.9]
      * - e.g. modify( { name[2] in { 'a', 'b' } }, "in", 'c' ) results in
      *   name[2] in { 'a', 'b', 'c' }
+     * - a { <=, >= } bound looser than the current one is ignored,
+     *   also on a { range }
      */
     bool modify( const std::string & op, double val );
+    bool modify( EOperator op, double val );
     /**
      * @in: condition
      * @out: true if modified, false otherwise
@@ -101,6 +122,52 @@ class CCondition{
     std::vector<std::size_t> not_covered_indices(
         const std::vector<std::vector<double>> & data,
         const std::vector<std::size_t> & input_indices ) const;
+    /**
+     * @in: dataset, data indices
+     * @out: indices covered by a given condition
+     * - same as above, reads the contiguous column of the dataset
+     */
+    std::vector<std::size_t> covered_indices(
+        const CDataset & data,
+        const std::vector<std::size_t> & input_indices ) const;
+    /**
+     * @in: dataset, data indices
+     * @out: indices not covered by a given condition
+     */
+    std::vector<std::size_t> not_covered_indices(
+        const CDataset & data,
+        const std::vector<std::size_t> & input_indices ) const;
+    /**
+     * @in: dataset, data indices, output buffer
+     * - writes the indices covered by a given condition into covered,
+     *   the buffer is overwritten and its capacity reused, it may
+     *   be the input itself (in-place filtering)
+     */
+    void covered_indices( const CDataset & data,
+                          const std::vector<std::size_t> & input_indices,
+                          std::vector<std::size_t> & covered ) const;
+    /**
+     * @in: dataset, data indices, output buffers
+     * - splits the input into covered and not covered indices in
+     *   a single pass, both keep the order of the input
+     * - covered may be the input itself, not_covered may not
+     */
+    void partition( const CDataset & data,
+                    const std::vector<std::size_t> & input_indices,
+                    std::vector<std::size_t> & covered,
+                    std::vector<std::size_t> & not_covered ) const;
+    /**
+     * @in: dataset, input coverage
+     * @out: rows of the input covered by a given condition
+     */
+    CCoverage covered_mask( const CDataset & data,
+                            const CCoverage & input ) const;
+    /**
+     * @in: dataset, input coverage
+     * @out: rows of the input not covered by a given condition
+     */
+    CCoverage not_covered_mask( const CDataset & data,
+                                const CCoverage & input ) const;
 
     /** uses to_string() */
     friend std::ostream & operator<<( std::ostream & out,
@@ -118,18 +185,64 @@ class CCondition{
      */
     const static std::vector<std::string> Operators;
 
+    /**
+     * @in: operator
+     * @out: operator code
+     * - throws std::invalid_argument for an unknown operator
+     */
+    static EOperator parse_operator( const std::string & op );
+    /** return string form of an operator code */
+    static const std::string & operator_name( EOperator op );
+
   private:
     std::string m_f;                // feature
     std::size_t m_ind;              // index
-    std::string m_op;               // operator
+    EOperator m_op;                 // operator
     std::vector<double> m_con_vals; // continuous values
     std::set<double> m_cat_vals;    // categorical values
 
     /**
-      * @in: operator (op)
-      * @out: true if op is valid operator, false otherwise
+      * Test of a single value for a given operator, specialised
+      * for every operator in ruleset.cpp. It copies the bounds
+      * of the condition, so that the scan loops keep them in
+      * registers.
       **/
-    bool check_operator( const std::string & op ) const;
+    template<EOperator Op> struct CTest;
+    /**
+      * @in: sorted categories of a dictionary-encoded column
+      * @out: bitset over the category codes, a bit is set if the
+      *       category is one of m_cat_vals
+      **/
+    std::vector<std::uint64_t> category_bits(
+        const std::vector<double> & categories ) const;
+    /**
+      * @in: dataset, data indices, output buffers
+      * - shared implementation of the CDataset overloads,
+      *   a null buffer is not filled
+      **/
+    void split( const CDataset & data,
+                const std::vector<std::size_t> & input_indices,
+                std::vector<std::size_t> * covered,
+                std::vector<std::size_t> * not_covered ) const;
+    /**
+      * @in: feature column, data indices
+      * @out: indices for which the test of Op equals Covered
+      **/
+    template<EOperator Op, bool Covered>
+    std::vector<std::size_t> filter(
+        const double * row,
+        const std::vector<std::size_t> & input_indices ) const;
+    /**
+      * @in: feature column, data indices
+      * @out: indices (not) covered by the condition
+      * - shared implementation of the public overloads
+      **/
+    std::vector<std::size_t> covered_indices(
+        const double * row,
+        const std::vector<std::size_t> & input_indices ) const;
+    std::vector<std::size_t> not_covered_indices(
+        const double * row,
+        const std::vector<std::size_t> & input_indices ) const;
 };
 
 /**
@@ -167,6 +280,8 @@ class CRule{
     std::size_t predicted_class( void ) const;
     bool predicts_class( std::size_t pr_class ) const;
     bool predicts_the_same( const CRule & x ) const;
+    /** returns true if the rule has a predicted class set */
+    bool shows_class( void ) const;
     std::string to_string( void ) const;
     std::size_t size( void ) const;
     bool operator==( const CRule & x ) const;
@@ -179,6 +294,37 @@ class CRule{
     std::vector<std::size_t> not_covered_indices(
         const std::vector<std::vector<double>> & data,
         const std::vector<std::size_t> & input_indices ) const;
+    std::vector<std::size_t> covered_indices(
+        const CDataset & data,
+        const std::vector<std::size_t> & input_indices ) const;
+    std::vector<std::size_t> not_covered_indices(
+        const CDataset & data,
+        const std::vector<std::size_t> & input_indices ) const;
+    /**
+     * @in: dataset, data indices, output buffer
+     * - buffer versions of the above, the buffer is overwritten and
+     *   its capacity reused, it may be the input itself
+     */
+    void covered_indices( const CDataset & data,
+                          const std::vector<std::size_t> & input_indices,
+                          std::vector<std::size_t> & covered ) const;
+    void not_covered_indices( const CDataset & data,
+                              const std::vector<std::size_t> & input_indices,
+                              std::vector<std::size_t> & not_covered ) const;
+    /**
+     * @in: dataset, data indices, output buffers
+     * - splits the input into covered and not covered indices,
+     *   the rule is evaluated once, the buffers must differ from
+     *   the input
+     */
+    void partition( const CDataset & data,
+                    const std::vector<std::size_t> & input_indices,
+                    std::vector<std::size_t> & covered,
+                    std::vector<std::size_t> & not_covered ) const;
+    CCoverage covered_mask( const CDataset & data,
+                            const CCoverage & input ) const;
+    CCoverage not_covered_mask( const CDataset & data,
+                                const CCoverage & input ) const;
 
     std::map<std::size_t,CCondition>::iterator i_begin( void );
     std::map<std::size_t,CCondition>::reverse_iterator i_rbegin( void );
@@ -240,6 +386,27 @@ class CRuleset{
     std::vector<std::size_t> not_covered_indices(
         const std::vector<std::vector<double>> & data,
         const std::vector<std::size_t> & input_indices ) const;
+    std::vector<std::size_t> covered_indices(
+        const CDataset & data,
+        const std::vector<std::size_t> & input_indices ) const;
+    std::vector<std::size_t> not_covered_indices(
+        const CDataset & data,
+        const std::vector<std::size_t> & input_indices ) const;
+    /** buffer versions, see CRule */
+    void covered_indices( const CDataset & data,
+                          const std::vector<std::size_t> & input_indices,
+                          std::vector<std::size_t> & covered ) const;
+    void not_covered_indices( const CDataset & data,
+                              const std::vector<std::size_t> & input_indices,
+                              std::vector<std::size_t> & not_covered ) const;
+    void partition( const CDataset & data,
+                    const std::vector<std::size_t> & input_indices,
+                    std::vector<std::size_t> & covered,
+                    std::vector<std::size_t> & not_covered ) const;
+    CCoverage covered_mask( const CDataset & data,
+                            const CCoverage & input ) const;
+    CCoverage not_covered_mask( const CDataset & data,
+                                const CCoverage & input ) const;
     friend std::ostream & operator<<( std::ostream & out,
                                       const CRuleset & src );
 
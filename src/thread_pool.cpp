@@ -0,0 +1,126 @@
+#ifndef __thread_poolcpp__
+#define __thread_poolcpp__
+
+#include "./thread_pool.hpp"
+
+// pool and worker index of the current thread, used to detect
+// nested runs
+static thread_local const CThreadPool * t_pool = nullptr;
+static thread_local std::size_t t_worker = 0;
+
+CThreadPool::CThreadPool( std::size_t n_threads ):
+    m_fn( nullptr ), m_tasks( 0 ), m_next( 0 ), m_active( 0 ),
+    m_generation( 0 ), m_stop( false ){
+
+  if( ! n_threads )
+    n_threads = std::max( 1u, std::thread::hardware_concurrency() );
+
+  for( std::size_t i = 1; i < n_threads; ++i )
+    m_workers.emplace_back( &CThreadPool::work, this, i );
+}
+
+CThreadPool::~CThreadPool( void ){
+  {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_stop = true;
+  }
+  m_start.notify_all();
+  for( auto & t : m_workers )
+    t.join();
+}
+
+std::size_t CThreadPool::size( void ) const{
+  return m_workers.size() + 1;
+}
+
+void CThreadPool::run( std::size_t tasks,
+                       const std::function<void( std::size_t, std::size_t )> & fn ){
+
+  if( ! tasks )
+    return;
+
+  if( t_pool == this || m_workers.empty() || tasks == 1 ){
+    std::size_t worker = t_pool == this ? t_worker : 0;
+    for( std::size_t i = 0; i < tasks; ++i )
+      fn( i, worker );
+    return;
+  }
+
+  std::lock_guard<std::mutex> run_lock( m_run_mutex );
+
+  {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_fn = &fn;
+    m_tasks = tasks;
+    m_next = 0;
+    m_error = nullptr;
+    m_active = m_workers.size();
+    ++m_generation;
+  }
+  m_start.notify_all();
+
+  const CThreadPool * prev_pool = t_pool;
+  std::size_t prev_worker = t_worker;
+  t_pool = this;
+  t_worker = 0;
+  execute( 0 );
+  t_pool = prev_pool;
+  t_worker = prev_worker;
+
+  std::exception_ptr error;
+  {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_done.wait( lock, [this]{ return ! m_active; } );
+    m_fn = nullptr;
+    error = m_error;
+    m_error = nullptr;
+  }
+
+  if( error )
+    std::rethrow_exception( error );
+}
+
+void CThreadPool::work( std::size_t worker ){
+
+  t_pool = this;
+  t_worker = worker;
+  std::size_t seen = 0;
+
+  while( true ){
+    {
+      std::unique_lock<std::mutex> lock( m_mutex );
+      m_start.wait( lock, [&]{ return m_stop || m_generation != seen; } );
+      if( m_stop )
+        return;
+      seen = m_generation;
+    }
+
+    execute( worker );
+
+    {
+      std::lock_guard<std::mutex> lock( m_mutex );
+      if( ! --m_active )
+        m_done.notify_one();
+    }
+  }
+}
+
+void CThreadPool::execute( std::size_t worker ){
+
+  while( true ){
+    std::size_t task = m_next++;
+    if( task >= m_tasks )
+      return;
+    try{
+      (*m_fn)( task, worker );
+    }
+    catch( ... ){
+      std::lock_guard<std::mutex> lock( m_mutex );
+      if( ! m_error )
+        m_error = std::current_exception();
+      m_next = m_tasks;
+    }
+  }
+}
+
+#endif /*__thread_poolcpp__*/
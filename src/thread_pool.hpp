@@ -0,0 +1,67 @@
+#ifndef __thread_poolhpp__
+#define __thread_poolhpp__
+
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+
+/**
+ * (C)ThreadPool is a fixed set of worker threads kept alive between
+ * calls, so that short parallel loops (e.g. one per grown condition)
+ * do not pay for thread creation.
+ * - run() is a blocking parallel for, the calling thread takes part
+ *   in it as the worker 0
+ * - tasks are handed out one by one through an atomic counter
+ * - run() called from inside a task of the same pool is executed
+ *   serially by the calling worker
+ */
+class CThreadPool{
+
+  public:
+    /**
+     * @in: number of threads including the caller,
+     *      0 uses the number of hardware threads
+     */
+    explicit CThreadPool( std::size_t n_threads );
+    ~CThreadPool( void );
+    CThreadPool( const CThreadPool & ) = delete;
+    CThreadPool & operator=( const CThreadPool & ) = delete;
+    /** return number of threads including the caller */
+    std::size_t size( void ) const;
+    /**
+     * @in: number of tasks, function of ( task, worker )
+     * - call fn for every task in [0, tasks), the worker is
+     *   in [0, size()) and no two tasks run on the same worker
+     *   at once, so it can index per-worker scratch space
+     * - the first exception thrown by a task stops handing out
+     *   further tasks and is rethrown to the caller
+     */
+    void run( std::size_t tasks,
+              const std::function<void( std::size_t, std::size_t )> & fn );
+
+  private:
+    std::vector<std::thread> m_workers;
+    std::mutex m_run_mutex; // one run() at a time
+    std::mutex m_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_done;
+    const std::function<void( std::size_t, std::size_t )> * m_fn;
+    std::size_t m_tasks;
+    std::atomic<std::size_t> m_next; // next task to hand out
+    std::size_t m_active; // workers still busy with the current run
+    std::size_t m_generation; // number of runs started
+    bool m_stop;
+    std::exception_ptr m_error;
+
+    /** worker thread main loop */
+    void work( std::size_t worker );
+    /** take tasks until there are none left */
+    void execute( std::size_t worker );
+};
+
+#endif /*__thread_poolhpp__*/
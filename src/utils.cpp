@@ -5,14 +5,37 @@
 
 double log_fact( std::size_t n ){
   // log( n! ) = log( n ) + log( n - 1 ) + ... + log( 1 )
-  // calc log( n! )
-  
-  long double val = 0.;
-
-  for( std::size_t i = n; i; --i )
-    val += log2( i );
-
-  return val;
+  // small n are summed once into a table, larger ones come from
+  // the Stirling series
+  // ln( n! ) ~ n * ln( n ) - n + 1/2 * ln( 2*pi*n )
+  //            + 1/( 12n ) - 1/( 360n^3 ) + 1/( 1260n^5 )
+  // - exact in double precision past the table
+  // - std::lgamma is avoided, it writes the global signgam and
+  //   log_fact is called from concurrent fits
+
+  static const std::vector<double> table = [](){
+    std::vector<double> values( LogFactTableSize );
+    long double val = 0.;
+    for( std::size_t i = 0; i < values.size(); ++i ){
+      if( i )
+        val += log2( i );
+      values[i] = val;
+    }
+    return values;
+  }();
+
+  if( n < table.size() )
+    return table[n];
+
+  static const double half_ln_2pi = (double)1/2 * std::log( 2 * acos( -1 ) );
+
+  double x = n;
+  double inv = 1. / x;
+  double inv2 = inv * inv;
+  double val = x * std::log( x ) - x + (double)1/2 * std::log( x ) + half_ln_2pi;
+  val += inv * ( (double)1/12 - inv2 * ( (double)1/360 - inv2 * (double)1/1260 ) );
+
+  return val / std::log( 2. );
 }
 
 double log_C( std::size_t n, std::size_t k ){
@@ -29,56 +52,41 @@ double log_C( std::size_t n, std::size_t k ){
 
 }
 
-double Slog_C( std::size_t n, std::size_t k ){
+double IREP_pruning_metric( std::size_t P, std::size_t N,
+                            std::size_t p, std::size_t n ){
+  if( P < 1 && N < 1 )
+    return 0.;
 
-  // log( n! ) ~ ( n + 1/2 ) * log( n ) - n + 1/2*log( 2*pi )
+  double ret_val = (double)( p + ( N - n ) )/( P + N );
+  return ret_val;
 
-  if( k > n )
+}
+
+double RIPPER_pruning_metric( std::size_t, std::size_t,
+                              std::size_t p, std::size_t n ){
+  if( p < 1 && n < 1 )
     return 0.;
-  else if( k == n || k == 0 )
-    return 1.; 
 
-  double val = ( n + (double)1/2 ) * log2( n );
-  val -= ( k + (double)1/2 ) * log2( k );
-  val -= ( n - k + (double)1/2) * log2( n - k );
-  val -= (double)1/2 * log2( 2 * acos( -1 ) );
-  
-  return val;
+  double ret_val = ( (double)p - (double)n ) / ( p + n );
+  return ret_val;
 
-} 
+}
 
-double IREP_pruning_metric( const std::vector<std::vector<double>> & X,
+double IREP_pruning_metric( const CDataset & X,
                             const CRule & rule,
                             const std::vector<std::size_t> & pos_prune,
                             const std::vector<std::size_t> & neg_prune ){
-  std::size_t P,N,p,n;
-  P = pos_prune.size();
-  N = neg_prune.size();
-  p = rule.covered_indices( X, pos_prune ).size();
-  n = rule.covered_indices( X, neg_prune ).size();
-
-  if( P < 1 && N < 1 )
-    return 0.;
-
-  double ret_val = (double)( p + ( N - n ) )/( P + N );
-  return ret_val;
-
+  return IREP_pruning_metric( pos_prune.size(), neg_prune.size(),
+                              rule.covered_indices( X, pos_prune ).size(),
+                              rule.covered_indices( X, neg_prune ).size() );
 }
 
-double RIPPER_pruning_metric( const std::vector<std::vector<double>> & X,
+double RIPPER_pruning_metric( const CDataset & X,
                               const CRule & rule,
                               const std::vector<std::size_t> & pos_prune,
                               const std::vector<std::size_t> & neg_prune ){
-  long long int p,n;
-  // TODO safe typecast?
-  p = (long long int)rule.covered_indices( X, pos_prune ).size();
-  n = (long long int)rule.covered_indices( X, neg_prune ).size();
-
-  if( p < 1 && n < 1 )
-    return 0.;
-
-  double ret_val = (double)( p - n ) / ( p + n );
-  return ret_val;
-
+  return RIPPER_pruning_metric( pos_prune.size(), neg_prune.size(),
+                                rule.covered_indices( X, pos_prune ).size(),
+                                rule.covered_indices( X, neg_prune ).size() );
 }
 #endif /*__utilscpp__*/
@@ -10,21 +10,33 @@
 #include <stdexcept>
 #include "ruleset.hpp"
 
-/** Calculate the base 2 logarithm of n. */
+/** Number of log-factorials kept in a table, see log_fact. */
+const std::size_t LogFactTableSize = 1 << 12;
+/** Calculate the base 2 logarithm of n!, in constant time, thread-safe. */
 double log_fact( std::size_t n );
 /** Calculate the base 2 logarithm of
   * binomial coefficient. */
 double log_C( std::size_t n, std::size_t k );
-/** Calculate Stirling's approximation of the base 2
-  * logarithm of binomial coefficient. */
-double Slog_C( std::size_t n, std::size_t k );
+/**
+ * @in: number of positive and negative pruning samples (P, N),
+ *      number of them covered by a rule (p, n)
+ * @out: IREP pruning metric, ( p + ( N - n ) ) / ( P + N )
+ */
+double IREP_pruning_metric( std::size_t P, std::size_t N,
+                            std::size_t p, std::size_t n );
+/**
+ * @in: see above
+ * @out: RIPPER pruning metric, ( p - n ) / ( p + n )
+ */
+double RIPPER_pruning_metric( std::size_t P, std::size_t N,
+                              std::size_t p, std::size_t n );
 /** Calculate the IREP pruning metric. */
-double IREP_pruning_metric( const std::vector<std::vector<double>> & X,
+double IREP_pruning_metric( const CDataset & X,
                             const CRule & rule,
                             const std::vector<std::size_t> & pos_prune,
                             const std::vector<std::size_t> & neg_prune );
 /** Calculate the RIPPER pruning metric. */
-double RIPPER_pruning_metric( const std::vector<std::vector<double>> & X,
+double RIPPER_pruning_metric( const CDataset & X,
                               const CRule & rule,
                               const std::vector<std::size_t> & pos_prune,
                               const std::vector<std::size_t> & neg_prune );
@@ -37,12 +49,12 @@ double RIPPER_pruning_metric( const std::vector<std::vector<double>> & X,
  *            https://stackoverflow.com/questions/1577475/c-sorting-and-keeping-track-of-indexes
  */
 template<typename T>
-std::vector<std::size_t> sort_by_indices( const std::vector<T> & v ){
+std::vector<std::size_t> sort_by_indices( const T * v, std::size_t size ){
 
-  if( v.size() == 0 )
+  if( size == 0 )
     return std::vector<std::size_t>();
 
-  std::vector<std::size_t> indices( v.size() );
+  std::vector<std::size_t> indices( size );
   std::iota( std::begin( indices ), std::end( indices ), 0 );
   
   std::sort(
@@ -53,6 +65,11 @@ std::vector<std::size_t> sort_by_indices( const std::vector<T> & v ){
   return indices;
 }
 
+template<typename T>
+std::vector<std::size_t> sort_by_indices( const std::vector<T> & v ){
+  return sort_by_indices( v.data(), v.size() );
+}
+
 /**
  * @in: vector v, indices of vector v
  * @out: vector with unique values and their counts
@@ -112,21 +129,21 @@ std::vector<std::pair<T,std::size_t>> count_unique_from_sorted(
   * - if idx is present, use only elements given by it
   */
 template<typename T>
-std::map<T,std::size_t> unique_counts( const std::vector<T> & v,
+std::map<T,std::size_t> unique_counts( const T * v, std::size_t size,
                                        const std::vector<std::size_t> & idx =
                                          std::vector<std::size_t>() ){
-  if( v.empty() )
+  if( ! size )
     return std::map<T,std::size_t>();
 
   std::map<T,std::size_t> uniques;
 
   if( idx.empty() ){
-    for( const auto & x : v ){
-      auto to_increment = uniques.find( x );
+    for( std::size_t i = 0; i < size; ++i ){
+      auto to_increment = uniques.find( v[i] );
       if( to_increment != uniques.end() )
         to_increment -> second += 1;
       else
-        uniques.insert( { x, 1 } );
+        uniques.insert( { v[i], 1 } );
     }
   }
   else{
@@ -142,6 +159,13 @@ std::map<T,std::size_t> unique_counts( const std::vector<T> & v,
   return uniques;
 }
 
+template<typename T>
+std::map<T,std::size_t> unique_counts( const std::vector<T> & v,
+                                       const std::vector<std::size_t> & idx =
+                                         std::vector<std::size_t>() ){
+  return unique_counts( v.data(), v.size(), idx );
+}
+
 /**
   * @in: vector v, indexes idx
   * @out: set of unique values
@@ -149,18 +173,17 @@ std::map<T,std::size_t> unique_counts( const std::vector<T> & v,
   * - if idx is present, use only values in v given by idx
   */
 template<typename T>
-std::set<T> unique( const std::vector<T> & v,
+std::set<T> unique( const T * v, std::size_t size,
                     const std::vector<std::size_t> & idx =
                       std::vector<std::size_t>() ){
 
-  if( ! v.size() )
+  if( ! size )
     return std::set<T>();
 
   std::set<T> uniques;
 
   if( ! idx.size() )
-    for( const auto & x : v )
-      uniques.insert( x );
+    uniques.insert( v, v + size );
   else
     for( const auto & i : idx )
       uniques.insert( v[i] );
@@ -169,6 +192,13 @@ std::set<T> unique( const std::vector<T> & v,
 
 }
 
+template<typename T>
+std::set<T> unique( const std::vector<T> & v,
+                    const std::vector<std::size_t> & idx =
+                      std::vector<std::size_t>() ){
+  return unique( v.data(), v.size(), idx );
+}
+
 /**
   * @in: iterator begin and end
   * @out: modified container
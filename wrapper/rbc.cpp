@@ -1,9 +1,16 @@
 #include <random>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <pybind11/numpy.h>
 #include "../src/logger.cpp"
+#include "../src/dataset.cpp"
+#include "../src/coverage.cpp"
+#include "../src/kernels.cpp"
+#include "../src/thread_pool.cpp"
 #include "../src/utils.cpp"
 #include "../src/ruleset.cpp"
+#include "../src/compiled_ruleset.cpp"
+#include "../src/interval_table.cpp"
 #include "../src/rule_learner.cpp"
 
 namespace py = pybind11;
@@ -15,20 +22,66 @@ class PyCRuleLearner : public CRuleLearnerBase{
 
   public:
     using CRuleLearnerBase::CRuleLearnerBase; // Inherit constructors
-    CRuleset fit( const std::vector<std::vector<double>> & X,
+    CRuleset fit( const CDataset & X,
                   const std::vector<std::size_t> & Y,
                   const std::vector<std::string> & feature_names,
                   std::size_t positive_class ) override {
       PYBIND11_OVERRIDE_PURE( CRuleset, CRuleLearnerBase, fit, X, Y, feature_names, positive_class );
     }
     std::vector<std::size_t> predict( const CRuleset & ruleset,
-                                      const std::vector<std::vector<double>> & X,
+                                      const CDataset & X,
                                       std::size_t positive_class ) const override{
       PYBIND11_OVERRIDE( std::vector<std::size_t>, CRuleLearnerBase, predict, ruleset, X, positive_class );
     }
+    std::vector<std::size_t> predict( const CRuleset & ruleset,
+                                      const CDataset & X,
+                                      std::size_t positive_class,
+                                      std::size_t n_threads ) const override{
+      PYBIND11_OVERRIDE( std::vector<std::size_t>, CRuleLearnerBase, predict, ruleset, X, positive_class, n_threads );
+    }
 };
 
 PYBIND11_MODULE( rbc, m ){
+  py::class_<CDataset>( m, "CDataset" )
+    .def(py::init<>())
+    .def(py::init<const std::vector<std::vector<double>> &>())
+    .def(py::init<const CDataset &>())
+    .def("rows", &CDataset::rows)
+    .def("cols", &CDataset::cols)
+    .def("stride", &CDataset::stride)
+    .def("at", &CDataset::at)
+    .def("to_vector", &CDataset::to_vector)
+    .def("encode_categories", &CDataset::encode_categories, py::arg("max_categories"))
+    .def("max_categories", &CDataset::max_categories)
+    .def("encoded", &CDataset::encoded)
+    .def("categories", &CDataset::categories)
+    .def("__copy__", []( const CDataset & self ){ return CDataset( self ); })
+    .def(py::pickle(
+      []( const CDataset & data ){ // __getstate__
+        return py::make_tuple( data.to_vector(), data.max_categories() );
+      },
+      []( py::tuple t ){ // __setstate__
+        if( t.size() != 1 && t.size() != 2 )
+          throw std::runtime_error("Invalid dataset tuple state!");
+        CDataset data( t[0].cast<std::vector<std::vector<double>>>() );
+        if( t.size() == 2 )
+          data.encode_categories( t[1].cast<std::size_t>() );
+        return data;
+      })
+    );
+
+  py::class_<CCoverage>( m, "CCoverage" )
+    .def(py::init<>())
+    .def(py::init<std::size_t, bool>(), py::arg("size"), py::arg("value") = false)
+    .def(py::init<std::size_t, const std::vector<std::size_t> &>())
+    .def("size", &CCoverage::size)
+    .def("count", &CCoverage::count)
+    .def("none", &CCoverage::none)
+    .def("test", &CCoverage::test)
+    .def("to_indices", &CCoverage::to_indices)
+    .def("__len__", &CCoverage::size)
+    .def("__eq__", &CCoverage::operator==);
+
   py::class_<CCondition>( m, "CCondition" )
     .def(py::init<const std::string &, std::size_t,
                   const std::string &, double>())
@@ -41,8 +94,16 @@ PYBIND11_MODULE( rbc, m ){
     .def("get_values", &CCondition::get_values)
     .def("modify", static_cast<bool (CCondition::*)(const std::string &, double )>(&CCondition::modify))
     .def("modify", static_cast<bool (CCondition::*)(const CCondition &)>(&CCondition::modify))
-    .def("covered_indices", &CCondition::covered_indices)
-    .def("not_covered_indices", &CCondition::not_covered_indices)
+    .def("covered_indices", static_cast<std::vector<std::size_t> (CCondition::*)(const std::vector<std::vector<double>> &,
+                                                                                   const std::vector<std::size_t> &) const>(&CCondition::covered_indices))
+    .def("covered_indices", static_cast<std::vector<std::size_t> (CCondition::*)(const CDataset &,
+                                                                                   const std::vector<std::size_t> &) const>(&CCondition::covered_indices))
+    .def("not_covered_indices", static_cast<std::vector<std::size_t> (CCondition::*)(const std::vector<std::vector<double>> &,
+                                                                                       const std::vector<std::size_t> &) const>(&CCondition::not_covered_indices))
+    .def("not_covered_indices", static_cast<std::vector<std::size_t> (CCondition::*)(const CDataset &,
+                                                                                       const std::vector<std::size_t> &) const>(&CCondition::not_covered_indices))
+    .def("covered_mask", &CCondition::covered_mask)
+    .def("not_covered_mask", &CCondition::not_covered_mask)
     .def("to_string", &CCondition::to_string)
     .def("__copy__", []( const CCondition & self ){ return CCondition( self ); })
     .def("__str__", &CCondition::to_string)
@@ -78,10 +139,19 @@ PYBIND11_MODULE( rbc, m ){
     .def("predicted_class", &CRule::predicted_class)
     .def("predicts_class", &CRule::predicts_class)
     .def("predicts_the_same", &CRule::predicts_the_same)
+    .def("shows_class", &CRule::shows_class)
     .def("to_string", &CRule::to_string)
     .def("size", &CRule::size)
-    .def("covered_indices", &CRule::covered_indices)
-    .def("not_covered_indices", &CRule::not_covered_indices)
+    .def("covered_indices", static_cast<std::vector<std::size_t> (CRule::*)(const std::vector<std::vector<double>> &,
+                                                                              const std::vector<std::size_t> &) const>(&CRule::covered_indices))
+    .def("covered_indices", static_cast<std::vector<std::size_t> (CRule::*)(const CDataset &,
+                                                                              const std::vector<std::size_t> &) const>(&CRule::covered_indices))
+    .def("not_covered_indices", static_cast<std::vector<std::size_t> (CRule::*)(const std::vector<std::vector<double>> &,
+                                                                                  const std::vector<std::size_t> &) const>(&CRule::not_covered_indices))
+    .def("not_covered_indices", static_cast<std::vector<std::size_t> (CRule::*)(const CDataset &,
+                                                                                  const std::vector<std::size_t> &) const>(&CRule::not_covered_indices))
+    .def("covered_mask", &CRule::covered_mask)
+    .def("not_covered_mask", &CRule::not_covered_mask)
     .def("__str__", &CRule::to_string)
     .def("__eq__", &CRule::operator==)
     .def("__setitem__", [](CRule & self, std::size_t i, const CCondition & value){ self[i] = value; })
@@ -120,8 +190,16 @@ PYBIND11_MODULE( rbc, m ){
     .def("pop", &CRuleset::pop)
     .def("to_string", &CRuleset::to_string)
     .def("size", &CRuleset::size)
-    .def("covered_indices", &CRuleset::covered_indices)
-    .def("not_covered_indices", &CRuleset::not_covered_indices)
+    .def("covered_indices", static_cast<std::vector<std::size_t> (CRuleset::*)(const std::vector<std::vector<double>> &,
+                                                                                 const std::vector<std::size_t> &) const>(&CRuleset::covered_indices))
+    .def("covered_indices", static_cast<std::vector<std::size_t> (CRuleset::*)(const CDataset &,
+                                                                                 const std::vector<std::size_t> &) const>(&CRuleset::covered_indices))
+    .def("not_covered_indices", static_cast<std::vector<std::size_t> (CRuleset::*)(const std::vector<std::vector<double>> &,
+                                                                                     const std::vector<std::size_t> &) const>(&CRuleset::not_covered_indices))
+    .def("not_covered_indices", static_cast<std::vector<std::size_t> (CRuleset::*)(const CDataset &,
+                                                                                     const std::vector<std::size_t> &) const>(&CRuleset::not_covered_indices))
+    .def("covered_mask", &CRuleset::covered_mask)
+    .def("not_covered_mask", &CRuleset::not_covered_mask)
     .def("__str__", &CRuleset::to_string)
     .def("__setitem__", [](CRuleset & self, std::size_t i, const CRule & value){ self[i] = value; })
     .def("__getitem__", static_cast<const CRule & (CRuleset::*)(std::size_t) const>(&CRuleset::operator[]))
@@ -144,6 +222,38 @@ PYBIND11_MODULE( rbc, m ){
       })
     );
 
+  py::class_<CCompiledRuleset>( m, "CCompiledRuleset" )
+    .def(py::init<>())
+    .def(py::init<const CRuleset &>())
+    .def("size", &CCompiledRuleset::size)
+    .def("checks", &CCompiledRuleset::checks)
+    .def("features", &CCompiledRuleset::features)
+    .def("covering_rule", static_cast<std::size_t (CCompiledRuleset::*)(const CDataset &,
+                                                                        std::size_t) const>(&CCompiledRuleset::covering_rule))
+    // a contiguous float64 row is read in place, without a copy
+    .def("predict_one", []( const CCompiledRuleset & self,
+                            py::array_t<double, py::array::c_style | py::array::forcecast> row,
+                            std::size_t positive_class ){
+        if( row.ndim() != 1 || (std::size_t)row.shape( 0 ) < self.features() )
+          throw std::invalid_argument( "Row has fewer values than the ruleset reads!" );
+        std::size_t rule;
+        std::size_t pr_class = self.predict_one( row.data(), positive_class, rule );
+        return py::make_tuple( pr_class, rule );
+      }, py::arg("row"), py::arg("positive_class") = 1 )
+    .def("shows_class", &CCompiledRuleset::shows_class)
+    .def("predicted_class", &CCompiledRuleset::predicted_class)
+    .def("__len__", &CCompiledRuleset::size);
+
+  py::class_<CIntervalTable>( m, "CIntervalTable" )
+    .def(py::init<>())
+    .def(py::init<const CRuleset &>())
+    .def_static("fits", &CIntervalTable::fits)
+    .def("size", &CIntervalTable::size)
+    .def("feature", &CIntervalTable::feature)
+    .def("covering_rule", &CIntervalTable::covering_rule)
+    .def("predict_one", &CIntervalTable::predict_one)
+    .def("__len__", &CIntervalTable::size);
+
   py::class_<CRuleLearner, PyCRuleLearner<>>( m, "CRuleLearner" )
     .def(py::init<>())
     .def(py::init<double, std::size_t, std::size_t, std::size_t, bool, std::size_t, const std::string &>())
@@ -151,7 +261,28 @@ PYBIND11_MODULE( rbc, m ){
     //.def_static("confusion_matrix", &CRuleLearner::confusion_matrix )
     .def_static("measure_accuracy", static_cast<double (*)(const std::vector<std::size_t> &, const std::vector<std::size_t> &)>(&CRuleLearner::measure_accuracy))
     .def_static("measure_accuracy", static_cast<double (*)(std::size_t, std::size_t, std::size_t, std::size_t)>(&CRuleLearner::measure_accuracy))
-    .def("fit", &CRuleLearner::fit)
+    .def("fit", static_cast<CRuleset (CRuleLearner::*)(const std::vector<std::vector<double>> &,
+                                                       const std::vector<std::size_t> &,
+                                                       const std::vector<std::string> &,
+                                                       std::size_t)>(&CRuleLearner::fit))
+    .def("fit", static_cast<CRuleset (CRuleLearner::*)(const CDataset &,
+                                                       const std::vector<std::size_t> &,
+                                                       const std::vector<std::string> &,
+                                                       std::size_t)>(&CRuleLearner::fit))
+    .def("fit_multiclass", static_cast<CRuleset (CRuleLearner::*)(const std::vector<std::vector<double>> &,
+                                                                  const std::vector<std::size_t> &,
+                                                                  const std::vector<std::string> &)>(&CRuleLearner::fit_multiclass))
+    .def("fit_multiclass", static_cast<CRuleset (CRuleLearner::*)(const CDataset &,
+                                                                  const std::vector<std::size_t> &,
+                                                                  const std::vector<std::string> &)>(&CRuleLearner::fit_multiclass))
+    .def("predict_multiclass", static_cast<std::vector<std::size_t> (CRuleLearner::*)(const CRuleset &,
+                                                                                      const std::vector<std::vector<double>> &) const>(&CRuleLearner::predict_multiclass))
+    .def("predict_multiclass", static_cast<std::vector<std::size_t> (CRuleLearner::*)(const CRuleset &,
+                                                                                      const CDataset &) const>(&CRuleLearner::predict_multiclass))
+    .def("predict_multiclass", static_cast<std::vector<std::size_t> (CRuleLearner::*)(const CRuleset &,
+                                                                                      const CDataset &,
+                                                                                      std::size_t) const>(&CRuleLearner::predict_multiclass),
+         py::arg("ruleset"), py::arg("X"), py::arg("n_threads"))
     // references not working
     //.def("pos_neg_split", &CRuleLearner::pos_neg_split)
     // reference not working
@@ -165,27 +296,93 @@ PYBIND11_MODULE( rbc, m ){
                                                           const std::vector<std::size_t> &,
                                                           const std::vector<std::size_t> &,
                                                           const CRule & r)>(&CRuleLearner::grow_rule))
-    .def("find_literal", &CRuleLearner::find_literal)
-    //.def("foil_metric", &CRuleLearner::foil_metric)
-    .def("prune_rule", &CRuleLearner::prune_rule)
+    .def("grow_rule", static_cast<CRule (CRuleLearner::*)(const CDataset &,
+                                                          const std::vector<std::string> &,
+                                                          const std::vector<std::size_t> &,
+                                                          const std::vector<std::size_t> &)>(&CRuleLearner::grow_rule))
+    .def("grow_rule", static_cast<CRule (CRuleLearner::*)(const CDataset &,
+                                                          const std::vector<std::string> &,
+                                                          const std::vector<std::size_t> &,
+                                                          const std::vector<std::size_t> &,
+                                                          const CRule & r)>(&CRuleLearner::grow_rule))
+    .def("find_literal", static_cast<CCondition * (CRuleLearner::*)(const std::vector<std::vector<double>> &,
+                                                                    const std::vector<std::string> &,
+                                                                    const std::vector<std::size_t> &,
+                                                                    const std::vector<std::size_t> &,
+                                                                    std::size_t, std::size_t)>(&CRuleLearner::find_literal))
+    .def("find_literal", static_cast<CCondition * (CRuleLearner::*)(const CDataset &,
+                                                                    const std::vector<std::string> &,
+                                                                    const std::vector<std::size_t> &,
+                                                                    const std::vector<std::size_t> &,
+                                                                    std::size_t, std::size_t)>(&CRuleLearner::find_literal))
+    .def("prune_rule", static_cast<CRule (CRuleLearner::*)(const CRule &,
+                                                           const std::vector<std::vector<double>> &,
+                                                           const std::vector<std::size_t> &,
+                                                           const std::vector<std::size_t> &)>(&CRuleLearner::prune_rule))
+    .def("prune_rule", static_cast<CRule (CRuleLearner::*)(const CRule &,
+                                                           const CDataset &,
+                                                           const std::vector<std::size_t> &,
+                                                           const std::vector<std::size_t> &)>(&CRuleLearner::prune_rule))
     //.def("IREP_pruning_metric", &CRuleLearner::IREP_pruning_metric)
-    .def("rule_error", &CRuleLearner::rule_error)
-    .def("predict", &CRuleLearner::predict);
+    .def("rule_error", static_cast<double (CRuleLearner::*)(const std::vector<std::vector<double>> &,
+                                                            const CRule &,
+                                                            const std::vector<std::size_t> &,
+                                                            const std::vector<std::size_t> &) const>(&CRuleLearner::rule_error))
+    .def("rule_error", static_cast<double (CRuleLearner::*)(const CDataset &,
+                                                            const CRule &,
+                                                            const std::vector<std::size_t> &,
+                                                            const std::vector<std::size_t> &) const>(&CRuleLearner::rule_error))
+    .def("set_histogram_bins", &CRuleLearner::set_histogram_bins, py::arg("max_bins"))
+    .def("predict", static_cast<std::vector<std::size_t> (CRuleLearner::*)(const CRuleset &,
+                                                                           const std::vector<std::vector<double>> &,
+                                                                           std::size_t) const>(&CRuleLearner::predict))
+    .def("predict", static_cast<std::vector<std::size_t> (CRuleLearner::*)(const CRuleset &,
+                                                                           const CDataset &,
+                                                                           std::size_t) const>(&CRuleLearner::predict))
+    .def("predict", static_cast<std::vector<std::size_t> (CRuleLearner::*)(const CRuleset &,
+                                                                           const CDataset &,
+                                                                           std::size_t,
+                                                                           std::size_t) const>(&CRuleLearner::predict),
+         py::arg("ruleset"), py::arg("X"), py::arg("positive_class"), py::arg("n_threads"));
 
   py::class_<COneR, CRuleLearner, PyCRuleLearner<COneR>>( m, "COneR" )
     .def(py::init<>())
-    .def("fit", &COneR::fit)
+    .def(py::init<std::size_t>(), py::arg("n_threads"))
+    .def("fit", static_cast<CRuleset (CRuleLearner::*)(const std::vector<std::vector<double>> &,
+                                                       const std::vector<std::size_t> &,
+                                                       const std::vector<std::string> &,
+                                                       std::size_t)>(&COneR::fit))
+    .def("fit", static_cast<CRuleset (COneR::*)(const CDataset &,
+                                                const std::vector<std::size_t> &,
+                                                const std::vector<std::string> &,
+                                                std::size_t)>(&COneR::fit))
+    .def("predict", static_cast<std::vector<std::size_t> (CRuleLearner::*)(const CRuleset &,
+                                                                           const std::vector<std::vector<double>> &,
+                                                                           std::size_t) const>(&COneR::predict),
+         py::arg("ruleset"), py::arg("X"), py::arg("positive_class") = 0 )
+    .def("predict", static_cast<std::vector<std::size_t> (COneR::*)(const CRuleset &,
+                                                                    const CDataset &,
+                                                                    std::size_t) const>(&COneR::predict),
+         py::arg("ruleset"), py::arg("X"), py::arg("positive_class") = 0 )
     .def("predict", static_cast<std::vector<std::size_t> (COneR::*)(const CRuleset &,
-                                                                    const std::vector<std::vector<double>> &,
+                                                                    const CDataset &,
+                                                                    std::size_t,
                                                                     std::size_t) const>(&COneR::predict),
-         py::arg("ruleset"), py::arg("X"), py::arg("positive_class") = 0 );
+         py::arg("ruleset"), py::arg("X"), py::arg("positive_class"), py::arg("n_threads") );
 
   py::class_<CIREP, CRuleLearner, PyCRuleLearner<CIREP>>( m, "CIREP" )
     .def(py::init<>())
     .def(py::init<double, std::size_t, std::size_t, bool, std::size_t, const std::string &>(),
          py::arg("split_ratio") = (double)2/3, py::arg("random_state") = std::random_device()(), py::arg("categorical_max") = 0,
          py::arg("prune_rules") = true, py::arg("n_threads") = 1, py::arg("pruning_metric") = "IREP_default" )
-    .def("fit", &CIREP::fit);
+    .def("fit", static_cast<CRuleset (CRuleLearner::*)(const std::vector<std::vector<double>> &,
+                                                       const std::vector<std::size_t> &,
+                                                       const std::vector<std::string> &,
+                                                       std::size_t)>(&CIREP::fit))
+    .def("fit", static_cast<CRuleset (CIREP::*)(const CDataset &,
+                                                const std::vector<std::size_t> &,
+                                                const std::vector<std::string> &,
+                                                std::size_t)>(&CIREP::fit));
 
   py::class_<CRIPPER, CRuleLearner, PyCRuleLearner<CRIPPER>>( m, "CRIPPER" )
     .def(py::init<>())
@@ -193,8 +390,28 @@ PYBIND11_MODULE( rbc, m ){
          py::arg("split_ratio") = (double)2/3, py::arg("random_state") = std::random_device()(), py::arg("categorical_max") = 0,
          py::arg("difference") = 64, py::arg("k") = 2, py::arg("prune_rules") = true, py::arg("n_threads") = 1,
          py::arg("pruning_metric") = "RIPPER_default" )
-    .def("fit", &CRIPPER::fit)
-    .def("optimise_ruleset", &CRIPPER::optimise_ruleset);
+    .def("fit", static_cast<CRuleset (CRuleLearner::*)(const std::vector<std::vector<double>> &,
+                                                       const std::vector<std::size_t> &,
+                                                       const std::vector<std::string> &,
+                                                       std::size_t)>(&CRIPPER::fit))
+    .def("fit", static_cast<CRuleset (CRIPPER::*)(const CDataset &,
+                                                  const std::vector<std::size_t> &,
+                                                  const std::vector<std::string> &,
+                                                  std::size_t)>(&CRIPPER::fit))
+    .def("optimise_ruleset", static_cast<CRuleset (CRIPPER::*)(const CRuleset &,
+                                                               const std::vector<std::vector<double>> &,
+                                                               const std::vector<std::size_t> &,
+                                                               const std::vector<std::string> &,
+                                                               const std::vector<std::size_t> &,
+                                                               const std::vector<std::size_t> &,
+                                                               std::size_t)>(&CRIPPER::optimise_ruleset))
+    .def("optimise_ruleset", static_cast<CRuleset (CRIPPER::*)(const CRuleset &,
+                                                               const CDataset &,
+                                                               const std::vector<std::size_t> &,
+                                                               const std::vector<std::string> &,
+                                                               const std::vector<std::size_t> &,
+                                                               const std::vector<std::size_t> &,
+                                                               std::size_t)>(&CRIPPER::optimise_ruleset));
 
   py::class_<CCompetitor, CRuleLearner, PyCRuleLearner<CCompetitor>>( m, "CCompetitor" )
     .def(py::init<>())
@@ -202,5 +419,12 @@ PYBIND11_MODULE( rbc, m ){
          py::arg("split_ratio") = (double)2/3, py::arg("random_state") = std::random_device()(), py::arg("categorical_max") = 0,
          py::arg("difference") = 64, py::arg("prune_rules") = true, py::arg("n_threads") = 1,
          py::arg("pruning_metric") = "RIPPER_default" )
-    .def("fit", &CCompetitor::fit);
+    .def("fit", static_cast<CRuleset (CRuleLearner::*)(const std::vector<std::vector<double>> &,
+                                                       const std::vector<std::size_t> &,
+                                                       const std::vector<std::string> &,
+                                                       std::size_t)>(&CCompetitor::fit))
+    .def("fit", static_cast<CRuleset (CCompetitor::*)(const CDataset &,
+                                                      const std::vector<std::size_t> &,
+                                                      const std::vector<std::string> &,
+                                                      std::size_t)>(&CCompetitor::fit));
 }